@@ -0,0 +1,241 @@
+#include <TimerTwo.h>
+#include <TimerTwoSoftPwm.h>
+#include <TimerTwoTone.h>
+#include <TimerTwoPcm.h>
+#include <TimerTwoBam.h>
+#include <TimerTwoWavetable.h>
+#include <avr/sleep.h>
+
+/*
+ Cycle count benchmark of the TimerTwo API and the interrupt service routine.
+ Timer1 runs without prescaler and is read before and after each call, the
+ cost of the empty measurement is subtracted. Interrupts are disabled during
+ a measurement. The interrupt service routine is called directly, the
+ hardware response (TIMERTWO_BENCHMARK_ISR_RESPONSE) is added. reti sets the
+ I flag, the cli after the call runs before a pending interrupt is taken.
+ With TIMERTWO_SOFTPWM_CHANNELS, TIMERTWO_TONE_VOICES, TIMERTWO_PCM or
+ TIMERTWO_BAM_ROWS the interrupt service routines of these modules are
+ measured as well.
+ The results are printed as CSV:
+ f_cpu,mode,api,period_us,prescaler,cycles
+ Run on a board or in simavr with benchmark.sh, which also reports the flash
+ and RAM footprint.
+*/
+
+/* 4 cycles interrupt response and 3 cycles jmp in the vector table instead of the 4 cycles call */
+#define TIMERTWO_BENCHMARK_ISR_RESPONSE     7u
+#define TIMERTWO_BENCHMARK_ISR_CALL         4u
+/* cli after the call */
+#define TIMERTWO_BENCHMARK_ISR_CLI          1u
+
+#define TIMERTWO_BENCHMARK_STRING(Name)     #Name
+#define TIMERTWO_BENCHMARK_SYMBOL(Name)     TIMERTWO_BENCHMARK_STRING(Name)
+
+/* measure the cycles of Statement with interrupts disabled */
+#define TIMERTWO_BENCHMARK(Api, Period, Statement)      TIMERTWO_BENCHMARK_CYCLES(Api, Period, 0u, Statement)
+#define TIMERTWO_BENCHMARK_ISR(Api, Period)             TIMERTWO_BENCHMARK_VECTOR(Api, Period, TIMERTWO_TICK_vect)
+#define TIMERTWO_BENCHMARK_VECTOR(Api, Period, Vector)  TIMERTWO_BENCHMARK_CYCLES(Api, Period, TIMERTWO_BENCHMARK_ISR_RESPONSE - TIMERTWO_BENCHMARK_ISR_CALL - TIMERTWO_BENCHMARK_ISR_CLI, TIMERTWO_BENCHMARK_CALL_VECTOR(Vector))
+#define TIMERTWO_BENCHMARK_CYCLES(Api, Period, Extra, Statement) \
+    do {                                                \
+        uint8_t SregSave = SREG;                        \
+        cli();                                          \
+        uint16_t Start = TCNT1;                         \
+        Statement;                                      \
+        uint16_t Stop = TCNT1;                          \
+        SREG = SregSave;                                \
+        printResult(Api, Period, Stop - Start + (Extra)); \
+    } while(0)
+
+/* direct call of a Timer2 interrupt service routine, reti sets the I flag again */
+#define TIMERTWO_BENCHMARK_CALL_VECTOR(Vector)  asm volatile("call " TIMERTWO_BENCHMARK_SYMBOL(Vector) "\n\tcli" ::: "memory")
+
+static const TimerTwo::TimeType Periods[] = { 20uL, 100uL, 250uL, 1000uL, 4000uL, 8000uL, 16000uL, 100000uL };
+static const uint16_t Prescalers[] = { 0u, 1u, 8u, 32u, 64u, 128u, 256u, 1024u };
+
+static uint16_t Overhead;
+static uint16_t Prescaler;
+static volatile uint32_t Sink;
+
+#if TIMERTWO_SOFTPWM_CHANNELS
+/* pins with distinct duty cycles, so every channel adds an edge */
+static const byte SoftPwmPins[] = { 4u, 5u, 6u, 7u, 8u, 9u, 10u, 12u };
+#endif
+#if TIMERTWO_TONE_VOICES
+static const char* const ToneRows[] = { "tone isr(1 voice)", "tone isr(2 voices)", "tone isr(3 voices)", "tone isr(4 voices)",
+                                        "tone isr(5 voices)", "tone isr(6 voices)", "tone isr(7 voices)", "tone isr(8 voices)" };
+#endif
+#if TIMERTWO_PCM
+static const byte PcmSamples[256] PROGMEM = { 0u };
+#endif
+#if TIMERTWO_BAM_ROWS
+/* rows first, then columns, pins 0 and 1 are used by Serial */
+static const byte BamPins[] = { 2u, 3u, 4u, 5u, 6u, 7u, 8u, 9u, 10u, 11u, 12u, 13u, 14u, 15u, 16u, 17u, 18u, 19u };
+# if ((TIMERTWO_BAM_ROWS + TIMERTWO_BAM_COLUMNS) > 18u)
+#  error "Benchmark: the BAM matrix can use the 18 pins 2 to 19"
+# endif
+#endif
+
+
+void timerCallback() {
+
+}
+
+void printResult(const char* Api, TimerTwo::TimeType Period, uint16_t Cycles) {
+    Serial.print(F_CPU);
+    Serial.print(',');
+    Serial.print(TIMERTWO_WAVEFORM_MODE);
+    Serial.print(',');
+    Serial.print(Api);
+    Serial.print(',');
+    Serial.print(Period);
+    Serial.print(',');
+    Serial.print(Prescaler);
+    Serial.print(',');
+    Serial.println(Cycles - Overhead);
+}
+
+/* the clock select bits are only written while the timer runs */
+void selectPeriod(TimerTwo::TimeType Period) {
+    Timer2.init(Period, timerCallback);
+    Timer2.start();
+    Prescaler = Prescalers[TCCR2B & (_BV(CS22) | _BV(CS21) | _BV(CS20))];
+    Timer2.stop();
+}
+
+void benchmarkPeriod(TimerTwo::TimeType Period) {
+    TimerTwo::TimeType Time;
+    uint32_t Value;
+
+    selectPeriod(Period);
+    TIMERTWO_BENCHMARK("init", Period, Timer2.init(Period, timerCallback));
+    TIMERTWO_BENCHMARK("setPeriod", Period, Timer2.setPeriod(Period));
+    /* start() waits for the first timer clock, up to one prescaler period. Without prescaler the wait ends with the
+       first read of TCNT2, so the call is only measured there */
+    if(1u == Prescaler) { TIMERTWO_BENCHMARK("start", Period, Timer2.start()); } else { Timer2.start(); }
+    TIMERTWO_BENCHMARK("read", Period, Timer2.read(Time); Sink = Time);
+    TIMERTWO_BENCHMARK("readTicks", Period, Timer2.readTicks(Value); Sink = Value);
+    TIMERTWO_BENCHMARK("readMicros", Period, Timer2.readMicros(Value); Sink = Value);
+    TIMERTWO_BENCHMARK_ISR("isr", Period);
+    TIMERTWO_BENCHMARK("stagePeriod+commitUpdate", Period, Timer2.stagePeriod(Period); Timer2.commitUpdate());
+    TIMERTWO_BENCHMARK_ISR("isr(update)", Period);
+    TIMERTWO_BENCHMARK_ISR("isr(update)", Period);
+    TIMERTWO_BENCHMARK("detachInterrupt", Period, Timer2.detachInterrupt());
+    TIMERTWO_BENCHMARK_ISR("isr(no callback)", Period);
+    TIMERTWO_BENCHMARK("attachInterrupt", Period, Timer2.attachInterrupt(timerCallback));
+    if(Timer2.enableDithering() == E_OK) {
+        TIMERTWO_BENCHMARK_ISR("isr(dithering)", Period);
+        TIMERTWO_BENCHMARK("disableDithering", Period, Timer2.disableDithering());
+    }
+    TIMERTWO_BENCHMARK("stop", Period, Timer2.stop());
+    TIMERTWO_BENCHMARK("resume", Period, Timer2.resume());
+    Timer2.stop();
+}
+
+void benchmarkPwm() {
+    TIMERTWO_BENCHMARK("enablePwm", 1000uL, Timer2.enablePwm(TimerTwo::PWM_PIN_3, 127u));
+    TIMERTWO_BENCHMARK("setPwmDuty", 1000uL, Timer2.setPwmDuty(TimerTwo::PWM_PIN_3, 64u));
+    TIMERTWO_BENCHMARK("stagePwmDuty+commitUpdate", 1000uL, Timer2.stagePwmDuty(TimerTwo::PWM_PIN_3, 32u); Timer2.commitUpdate());
+    TIMERTWO_BENCHMARK("disablePwm", 1000uL, Timer2.disablePwm(TimerTwo::PWM_PIN_3));
+}
+
+/* interrupt service routines of the modules, the timer is stopped so only the direct calls run them */
+void benchmarkModules() {
+#if TIMERTWO_SOFTPWM_CHANNELS
+    selectPeriod(4096uL);
+    for(byte Index = 0u; (Index < sizeof(SoftPwmPins)) && (Index < TIMERTWO_SOFTPWM_CHANNELS); Index++) {
+        Timer2SoftPwm.attach(SoftPwmPins[Index], static_cast<byte>((Index + 1u) * 28u));
+    }
+    Timer2.start();
+    Timer2SoftPwm.begin();
+    Timer2.stop();
+    /* the edges of one period, the first one at BOTTOM sets the pins */
+    for(byte Edge = 0u; Edge <= TIMERTWO_SOFTPWM_CHANNELS; Edge++) {
+        TIMERTWO_BENCHMARK_VECTOR("softpwm isr(edge)", 4096uL, TIMER2_COMPB_vect);
+    }
+    Timer2SoftPwm.end();
+#endif
+#if TIMERTWO_TONE_VOICES
+    selectPeriod(1000uL);
+    Timer2Tone.begin();
+    for(byte Voice = 0u; Voice < TIMERTWO_TONE_VOICES; Voice++) {
+        Timer2Tone.play(Voice, 440u + (Voice * 110u), 0u, TimerTwoWavetableSine);
+        TIMERTWO_BENCHMARK_ISR(ToneRows[Voice], 1000uL);
+    }
+    Timer2Tone.end();
+    Timer2.stop();
+#endif
+#if TIMERTWO_PCM
+    /* 8 kHz, the last sample of a block switches the blocks and enables the prefetch interrupt */
+    Timer2Pcm.begin(8000uL);
+    Timer2Pcm.play(PcmSamples, sizeof(PcmSamples));
+    Prescaler = Prescalers[TCCR2B & (_BV(CS22) | _BV(CS21) | _BV(CS20))];
+    TCCR2B &= static_cast<byte>(~(_BV(CS22) | _BV(CS21) | _BV(CS20)));
+    TIFR2 = _BV(OCF2A) | _BV(TOV2);
+    for(byte Sample = 0u; Sample < TIMERTWO_PCM_BLOCK_SIZE; Sample++) {
+        TIMERTWO_BENCHMARK_ISR("pcm isr(sample)", 1000000uL / 8000uL);
+    }
+    /* the prefetch enables the interrupts, so Serial and Timer0 must not interrupt it */
+    Serial.flush();
+    byte Timsk0Save = TIMSK0;
+    TIMSK0 = 0u;
+    TIMERTWO_BENCHMARK_VECTOR("pcm isr(prefetch)", 1000000uL / 8000uL, TIMER2_COMPA_vect);
+    TIMSK0 = Timsk0Save;
+    Timer2Pcm.end();
+#endif
+#if TIMERTWO_BAM_ROWS
+    /* the planes of row 0 at the maximum frame rate, plane 0 selects the row and swaps the frame shown by show() */
+    Timer2Bam.init(&BamPins[0u], &BamPins[TIMERTWO_BAM_ROWS]);
+    Timer2Bam.begin(TimerTwoBam::getFrameRateMax());
+    Prescaler = Prescalers[TCCR2B & (_BV(CS22) | _BV(CS21) | _BV(CS20))];
+    TCCR2B &= static_cast<byte>(~(_BV(CS22) | _BV(CS21) | _BV(CS20)));
+    TIFR2 = _BV(OCF2A);
+    for(byte Column = 0u; Column < TIMERTWO_BAM_COLUMNS; Column++) { Timer2Bam.setPixel(0u, Column, static_cast<byte>(Column * 37u)); }
+    Timer2Bam.show();
+    for(byte Plane = 0u; Plane < TIMERTWOBAM_NUMBER_OF_PLANES; Plane++) {
+        TIMERTWO_BENCHMARK_VECTOR("bam isr(plane)", 1000000uL / Timer2Bam.getFrameRate(), TIMER2_COMPA_vect);
+    }
+    Timer2Bam.end();
+#endif
+}
+
+void setup() {
+    Serial.begin(115200);
+    /* Timer1 normal mode without prescaler */
+    TCCR1A = 0u;
+    TCCR1B = _BV(CS10);
+
+    /* cycles of the measurement itself */
+    cli();
+    uint16_t Start = TCNT1;
+    uint16_t Stop = TCNT1;
+    sei();
+    Overhead = Stop - Start;
+
+    Serial.println(F("f_cpu,mode,api,period_us,prescaler,cycles"));
+#if !TIMERTWO_PCM && !TIMERTWO_BAM_ROWS
+    /* the PCM player and the BAM driver replace the tick interrupt of the library and own Timer2 */
+    for(byte Index = 0u; Index < (sizeof(Periods) / sizeof(Periods[0])); Index++) {
+        benchmarkPeriod(Periods[Index]);
+    }
+    selectPeriod(1000uL);
+# if (TIMERTWO_TONE_VOICES == 0u)
+    /* the templates are not available with the tone generator */
+    TIMERTWO_BENCHMARK("init<1000>", 1000uL, Timer2.init<1000uL>(timerCallback));
+    TIMERTWO_BENCHMARK("setPeriod<1000>", 1000uL, Timer2.setPeriod<1000uL>());
+# endif
+    benchmarkPwm();
+#endif
+    benchmarkModules();
+    Serial.println(F("# done"));
+    Serial.flush();
+
+    /* simavr quits when the CPU sleeps with interrupts disabled */
+    cli();
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+    sleep_enable();
+    sleep_cpu();
+}
+
+void loop() {
+
+}
@@ -0,0 +1,62 @@
+#!/bin/sh
+# Cycle count and footprint benchmark of the TimerTwo library.
+#
+# Builds Benchmark.ino with arduino-cli for every F_CPU and waveform mode and for every module in the waveform mode
+# it needs, runs it in simavr and writes
+#   cycles.csv      f_cpu,mode,api,period_us,prescaler,cycles
+#   footprint.csv   f_cpu,mode,symbol,section,bytes (TimerTwo symbols, avr-nm) and the totals of avr-size
+#   load.csv        f_cpu,mode,module,case,cycles,rate_hz,load_percent (interrupt load of the modules, load.awk)
+#
+# usage: benchmark.sh [output directory]
+# environment: F_CPUS (default "16000000 8000000"), MODES (default "1 2 3 5 7"), FQBN (default arduino:avr:uno),
+#              MODULES (mode:defines pairs, the defines separated by commas, default soft PWM with 8 channels, tone with
+#              4 voices, PCM and a BAM matrix of 4 rows and 8 columns)
+
+set -e
+
+SKETCH_DIR=$(cd "$(dirname "$0")" && pwd)
+LIBRARY_DIR=$(cd "$SKETCH_DIR/.." && pwd)
+OUTPUT_DIR=${1:-$SKETCH_DIR/results}
+F_CPUS=${F_CPUS:-"16000000 8000000"}
+MODES=${MODES:-"1 2 3 5 7"}
+FQBN=${FQBN:-arduino:avr:uno}
+MODULES=${MODULES:-"2:TIMERTWO_SOFTPWM_CHANNELS=8u 3:TIMERTWO_TONE_VOICES=4u 7:TIMERTWO_PCM=1 2:TIMERTWO_BAM_ROWS=4u,TIMERTWO_BAM_COLUMNS=8u"}
+
+mkdir -p "$OUTPUT_DIR"
+echo "f_cpu,mode,api,period_us,prescaler,cycles" > "$OUTPUT_DIR/cycles.csv"
+echo "f_cpu,mode,symbol,section,bytes" > "$OUTPUT_DIR/footprint.csv"
+
+# build and run the sketch for F_CPU and MODE, $1 are extra compiler flags and $2 the suffix of the build directory
+run() {
+    BUILD_DIR="$OUTPUT_DIR/build-$F_CPU-$MODE$2"
+    arduino-cli compile --fqbn "$FQBN" --library "$LIBRARY_DIR" --output-dir "$BUILD_DIR" \
+        --build-property "build.f_cpu=${F_CPU}L" \
+        --build-property "compiler.cpp.extra_flags=-DTIMERTWO_WAVEFORM_MODE=${MODE}u $1" \
+        "$SKETCH_DIR" > /dev/null
+    ELF="$BUILD_DIR/Benchmark.ino.elf"
+
+    # flash and RAM of the whole sketch and of every TimerTwo symbol
+    avr-size -A "$ELF" | awk -v f="$F_CPU" -v m="$MODE" \
+        '$1 == ".text" || $1 == ".data" || $1 == ".bss" { print f "," m ",total," $1 "," $2 }' >> "$OUTPUT_DIR/footprint.csv"
+    avr-nm -C -S -t d --size-sort "$ELF" | grep -i "timertwo\|Timer2\|__vector_7\|__vector_8\|__vector_9" | awk -v f="$F_CPU" -v m="$MODE" '
+        { size = $2 + 0; type = tolower($3); $1 = $2 = $3 = ""; sub(/^ +/, "")
+          section = (type == "t") ? ".text" : (type == "d") ? ".data" : (type == "b") ? ".bss" : type
+          print f "," m ",\"" $0 "\"," section "," size }' >> "$OUTPUT_DIR/footprint.csv"
+
+    # the sketch prints the CSV rows on the UART and sleeps with interrupts disabled when done
+    simavr -m atmega328p -f "$F_CPU" "$ELF" 2>&1 | sed 's/\x1b\[[0-9;]*m//g' | grep -E "^[0-9]+,[0-9]+," >> "$OUTPUT_DIR/cycles.csv"
+}
+
+for F_CPU in $F_CPUS; do
+    for MODE in $MODES; do
+        run "" ""
+    done
+    for MODULE in $MODULES; do
+        MODE=${MODULE%%:*}
+        DEFINES=${MODULE#*:}
+        run "$(echo "$DEFINES" | sed 's/^/-D/; s/,/ -D/g')" "-${DEFINES%%=*}"
+    done
+done
+
+awk -f "$SKETCH_DIR/load.awk" "$OUTPUT_DIR/cycles.csv" > "$OUTPUT_DIR/load.csv"
+echo "results in $OUTPUT_DIR"
@@ -0,0 +1,78 @@
+# Interrupt load of the TimerTwo modules from the cycles.csv of benchmark.sh, the cases are the ones of the README tables.
+#
+# usage: awk -f load.awk cycles.csv > load.csv
+# output: f_cpu,mode,module,case,cycles,rate_hz,load_percent
+#         cycles are the CPU cycles of the interrupts per period of the module (PWM period), rate_hz the periods per second
+
+BEGIN {
+    FS = ","
+    print "f_cpu,mode,module,case,cycles,rate_hz,load_percent"
+}
+
+function load(Key, Module, Case, Cycles, Rate) {
+    split(Key, Build, SUBSEP)
+    printf "%s,%s,%s,%s,%.0f,%.0f,%.2f\n", Build[1], Build[2], Module, Case, Cycles, Rate, (Cycles * Rate * 100) / Build[1]
+}
+
+# the first row of a build is the interrupt at BOTTOM, the others are one edge each
+$3 == "softpwm isr(edge)" {
+    Key = $1 SUBSEP $2
+    if(!(Key in SoftPwmRows)) { SoftPwmBottom[Key] = $6 } else { SoftPwmEdges[Key] += $6 }
+    SoftPwmRows[Key]++
+}
+
+# the tick with N playing voices, one sample per hardware period of Timer2 with TOP 0xFF
+$3 ~ /^tone isr\(/ {
+    Voices = $3; sub(/^tone isr\(/, "", Voices); sub(/ .*/, "", Voices)
+    ToneCycles[$1 SUBSEP $2 SUBSEP Voices] = $6
+}
+
+# the 8 planes of one matrix row, a row takes 255 plane units
+$3 == "bam isr(plane)" {
+    BamCycles[$1 SUBSEP $2] += $6
+}
+
+# the samples of one block and its prefetch
+$3 == "pcm isr(sample)" {
+    PcmSamples[$1 SUBSEP $2]++
+    PcmCycles[$1 SUBSEP $2] += $6
+}
+$3 == "pcm isr(prefetch)" {
+    PcmCycles[$1 SUBSEP $2] += $6
+}
+
+END {
+    for(Key in SoftPwmRows) {
+        split(Key, Build, SUBSEP)
+        Edge = (SoftPwmRows[Key] > 1) ? (SoftPwmEdges[Key] / (SoftPwmRows[Key] - 1)) : 0
+        for(Channels = 1; Channels < SoftPwmRows[Key]; Channels++) {
+            Cycles = SoftPwmBottom[Key] + (Channels * Edge)
+            load(Key, "softpwm", Channels " channels normal mode prescaler 256", Cycles, Build[1] / (256 * 256))
+            load(Key, "softpwm", Channels " channels normal mode prescaler 64", Cycles, Build[1] / (256 * 64))
+        }
+    }
+    # the tick costs the same in both 8 bit modes, the sample rates of all four cases from the build of one mode
+    for(ToneKey in ToneCycles) {
+        split(ToneKey, Build, SUBSEP)
+        Key = Build[1] SUBSEP Build[2]
+        Voices = Build[3]
+        Cycles = ToneCycles[ToneKey]
+        # 8 voices in fast PWM with clock select 1 are rejected by #error
+        if(Voices != 8) { load(Key, "tone", Voices " voices fast PWM clock select 1", Cycles, Build[1] / 256) }
+        load(Key, "tone", Voices " voices phase correct clock select 1", Cycles, Build[1] / 510)
+        load(Key, "tone", Voices " voices fast PWM clock select 2", Cycles, Build[1] / 2048)
+        load(Key, "tone", Voices " voices phase correct clock select 2", Cycles, Build[1] / 4080)
+    }
+    for(Key in PcmSamples) {
+        Cycles = PcmCycles[Key] / PcmSamples[Key]
+        load(Key, "pcm", "8000 Hz", Cycles, 8000)
+        load(Key, "pcm", "16000 Hz", Cycles, 16000)
+        load(Key, "pcm", "22050 Hz", Cycles, 21978)
+    }
+    # the load does not depend on the number of rows, only on the plane unit
+    for(Key in BamCycles) {
+        split(Key, Build, SUBSEP)
+        load(Key, "bam", "128 cycle unit", BamCycles[Key], Build[1] / (255 * 128))
+        load(Key, "bam", "256 cycle unit", BamCycles[Key], Build[1] / (255 * 256))
+    }
+}
@@ -0,0 +1,114 @@
+#!/usr/bin/env python3
+"""Flat profile of a TimerTwoProfiler dump.
+
+Reads the binary histogram written by Timer2Profiler.dump() from a file (or a serial port with pyserial) and maps
+the bins to the functions of the ELF file with avr-nm, like the flat profile of gprof. The dump can be embedded in
+other serial output, it is found by its magic "T2PF".
+
+usage: timertwo_profile.py [--nm avr-nm] [--csv] [--port /dev/ttyACM0 --baud 115200] ELF [DUMP]
+"""
+
+import argparse
+import struct
+import subprocess
+import sys
+
+MAGIC = b"T2PF"
+HEADER = struct.Struct("<4sBBHHII")
+
+
+def read_dump(data):
+    start = data.find(MAGIC)
+    if start < 0:
+        sys.exit("no TimerTwoProfiler dump found")
+    magic, version, shift, count, pc_start, samples, outside = HEADER.unpack_from(data, start)
+    if version != 1:
+        sys.exit("unsupported dump version %d" % version)
+    bins = struct.unpack_from("<%dH" % count, data, start + HEADER.size)
+    return shift, pc_start, samples, outside, bins
+
+
+def read_port(port, baud, count_hint=4096):
+    import serial
+    with serial.Serial(port, baud, timeout=5) as connection:
+        data = b""
+        while True:
+            chunk = connection.read(count_hint)
+            data += chunk
+            start = data.find(MAGIC)
+            if start >= 0 and len(data) - start >= HEADER.size:
+                count = HEADER.unpack_from(data, start)[3]
+                if len(data) - start >= HEADER.size + 2 * count:
+                    return data
+            if not chunk:
+                sys.exit("timeout while waiting for the dump")
+
+
+def read_symbols(nm, elf):
+    """sorted list of (start byte address, end byte address, name) of the functions"""
+    output = subprocess.run([nm, "-C", "-n", "-S", elf], check=True, capture_output=True, text=True).stdout
+    symbols = []
+    for line in output.splitlines():
+        fields = line.split(None, 3)
+        if len(fields) == 4 and fields[2] in "tTwW":
+            address = int(fields[0], 16)
+            symbols.append((address, address + int(fields[1], 16), fields[3]))
+    return symbols
+
+
+def find_symbol(symbols, address):
+    for start, end, name in symbols:
+        if start <= address < end:
+            return name
+    return "0x%04x" % address
+
+
+def main():
+    parser = argparse.ArgumentParser(description="flat profile of a TimerTwoProfiler dump")
+    parser.add_argument("elf")
+    parser.add_argument("dump", nargs="?", help="file with the serial output, default stdin")
+    parser.add_argument("--nm", default="avr-nm")
+    parser.add_argument("--csv", action="store_true", help="print symbol,samples,percent")
+    parser.add_argument("--port", help="read the dump from a serial port (pyserial)")
+    parser.add_argument("--baud", type=int, default=115200)
+    args = parser.parse_args()
+
+    if args.port:
+        data = read_port(args.port, args.baud)
+    elif args.dump:
+        with open(args.dump, "rb") as dump:
+            data = dump.read()
+    else:
+        data = sys.stdin.buffer.read()
+
+    shift, pc_start, samples, outside, bins = read_dump(data)
+    symbols = read_symbols(args.nm, args.elf)
+
+    # a bin is attributed to the function of its first byte, so use a small bin shift for exact results
+    profile = {}
+    for index, count in enumerate(bins):
+        if count:
+            address = 2 * (pc_start + (index << shift))
+            name = find_symbol(symbols, address)
+            profile[name] = profile.get(name, 0) + count
+    binned = sum(bins)
+
+    rows = sorted(profile.items(), key=lambda item: item[1], reverse=True)
+    if args.csv:
+        print("symbol,samples,percent")
+        for name, count in rows:
+            print('"%s",%d,%.2f' % (name, count, 100.0 * count / binned))
+        return
+
+    print("Flat profile, %d samples (%d outside of the histogram), %d bytes per bin" % (samples, outside, 2 << shift))
+    print()
+    print("  %time   cumulative   samples  name")
+    cumulative = 0.0
+    for name, count in rows:
+        percent = 100.0 * count / binned
+        cumulative += percent
+        print("%7.2f %12.2f %9d  %s" % (percent, cumulative, count, name))
+
+
+if __name__ == "__main__":
+    main()
@@ -2,7 +2,7 @@
 
 /*
 /*
- This example toggles the PIN13 cyclically all 1ms and starts the PWM for PIN11.
+ This example toggles the PIN13 cyclically all 1ms and starts the PWM for PIN3.
  The frequency of the PWM depends on the period of the timer. Furthermore the
  use of the read method is demonstrated.
 */
@@ -20,7 +20,8 @@ void setup() {
 	    // Something went wrong, check your parameters
         while(1);
     }
-    if(Timer2.enablePwm(TimerTwo::PWM_PIN_11, 127) == E_NOT_OK) {
+    // PWM on pin 11 needs a fixed TOP mode, see TIMERTWO_WAVEFORM_MODE in TimerTwo_Cfg.h
+    if(Timer2.enablePwm(TimerTwo::PWM_PIN_3, 127) == E_NOT_OK) {
         // Something went wrong, has init function already been called?
         while(1);
     }
@@ -0,0 +1,231 @@
+/*
+ Host test of the TimerTwo modules against the Timer2 model of TimerTwoHost.
+ Each module needs its own configuration and waveform mode, test.sh builds
+ this file once per module, e. g. for the software PWM:
+ g++ -std=gnu++11 -I.. -DTIMERTWO_WAVEFORM_MODE=2u -DTIMERTWO_SOFTPWM_CHANNELS=4u ../TimerTwo*.cpp TimerTwoModuleTest.cpp
+ Like TimerTwoTest.cpp the exit code is the number of failed checks.
+*/
+#include "TimerTwo.h"
+#include "TimerTwoSoftPwm.h"
+#include "TimerTwoBam.h"
+#include "TimerTwoDds.h"
+#include "TimerTwoTone.h"
+#include "TimerTwoPcm.h"
+#include "TimerTwoProfiler.h"
+#include "TimerTwoWavetable.h"
+#include <stdio.h>
+#include <string.h>
+
+#define TIMERTWO_TEST_CHECK(Condition)                                                                  \
+    do {                                                                                                \
+        if(!(Condition)) {                                                                              \
+            printf("%s:%d: mode %u: %s\n", __FILE__, __LINE__, TIMERTWO_WAVEFORM_MODE, #Condition);     \
+            Failures++;                                                                                 \
+        }                                                                                               \
+    } while(0)
+
+static unsigned Failures;
+
+
+bool isNear(uint64_t Value, uint64_t Expected, uint64_t Tolerance) {
+    return (Value + Tolerance >= Expected) && (Value <= Expected + Tolerance);
+}
+
+/* run the model for at least Cycles CPU cycles, the interrupts add their own cycles, returns the cycles run */
+uint64_t run(uint64_t Cycles) {
+    uint64_t Start = Timer2Host.getCycles();
+    while(Timer2Host.getCycles() - Start < Cycles) { Timer2Host.step(1u); }
+    return Timer2Host.getCycles() - Start;
+}
+
+
+#if TIMERTWO_SOFTPWM_CHANNELS
+/* every attached pin is high for Duty / 256 of the hardware period, the edge interrupt is late by its response */
+void testSoftPwm() {
+    static const byte Pins[] = { 4u, 5u, 8u, 14u };
+    static const byte Duties[] = { 32u, 100u, 200u, 255u };
+
+    TIMERTWO_TEST_CHECK(Timer2.init(1024u) == E_OK);
+    for(byte Channel = 0u; Channel < 4u; Channel++) { TIMERTWO_TEST_CHECK(Timer2SoftPwm.attach(Pins[Channel], Duties[Channel]) == E_OK); }
+    TIMERTWO_TEST_CHECK(Timer2.start() == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2SoftPwm.begin() == E_OK);
+    Timer2Host.stepMicroseconds(4096u);
+    Timer2Host.resetOutputStatistics();
+    uint32_t Interrupts = Timer2Host.getInterruptCount(TIMER2_COMPB_vect);
+    uint64_t Cycles = run(16u * 1024u * (F_CPU / 1000000uL));
+    for(byte Channel = 0u; Channel < 4u; Channel++) {
+        TIMERTWO_TEST_CHECK(isNear(Timer2Host.getPinHighCycles(Pins[Channel]), (Cycles * Duties[Channel]) >> 8u, Cycles / 64u));
+    }
+    /* BOTTOM and one edge per channel below 255 per period */
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getInterruptCount(TIMER2_COMPB_vect) - Interrupts, 16u * 4u, 1u));
+    /* all pins are cleared */
+    Timer2SoftPwm.end();
+    uint64_t HighCycles = Timer2Host.getPinHighCycles(Pins[3]);
+    Timer2Host.stepMicroseconds(1024u);
+    TIMERTWO_TEST_CHECK(Timer2Host.getPinHighCycles(Pins[3]) == HighCycles);
+}
+#endif
+
+#if TIMERTWO_BAM_ROWS
+/* one interrupt per plane and row, a full pixel keeps its column on for the whole row */
+void testBam() {
+    static const byte RowPins[TIMERTWO_BAM_ROWS] = { 14u, 15u };
+    static const byte ColumnPins[TIMERTWO_BAM_COLUMNS] = { 4u, 5u, 6u, 7u };
+
+    TIMERTWO_TEST_CHECK(Timer2Bam.init(RowPins, ColumnPins) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Bam.begin(100u) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Bam.getFrameRate() >= 100u);
+    for(byte Row = 0u; Row < TIMERTWO_BAM_ROWS; Row++) { Timer2Bam.setPixel(Row, 0u, 255u); Timer2Bam.setPixel(Row, 1u, 128u); }
+    TIMERTWO_TEST_CHECK(Timer2Bam.show() == E_OK);
+    /* the plane unit is a power of two CPU cycles, the frame rate is rounded down */
+    uint32_t Unit = 1u;
+    while((Unit << 1u) <= (F_CPU / (TIMERTWOBAM_ROW_UNITS * TIMERTWO_BAM_ROWS * static_cast<uint32_t>(Timer2Bam.getFrameRate())))) { Unit <<= 1u; }
+    uint32_t Frame = TIMERTWOBAM_ROW_UNITS * TIMERTWO_BAM_ROWS * Unit;
+    Timer2Host.step(2u * Frame);
+    Timer2Host.resetOutputStatistics();
+    uint32_t Interrupts = Timer2Host.getInterruptCount(TIMER2_COMPA_vect);
+    run(8u * Frame);
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getInterruptCount(TIMER2_COMPA_vect) - Interrupts, 8u * TIMERTWO_BAM_ROWS * 8u, 1u));
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getPinHighCycles(ColumnPins[0]), 8u * Frame, Frame / 8u));
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getPinHighCycles(ColumnPins[1]), 4u * Frame, Frame / 8u));
+    TIMERTWO_TEST_CHECK(Timer2Host.getPinHighCycles(ColumnPins[2]) == 0u);
+    Timer2Bam.end();
+}
+#endif
+
+#if TIMERTWO_DDS
+/* the sine wave averages to the middle level, one sample per hardware period */
+void testDds() {
+    TIMERTWO_TEST_CHECK(Timer2Dds.begin(TimerTwoWavetableSine, 1000000uL) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Dds.getFrequency() / 1000u == 1000u);
+    Timer2Host.stepMicroseconds(1000u);
+    Timer2Host.resetOutputStatistics();
+    uint32_t Interrupts = Timer2Host.getInterruptCount(TIMER2_OVF_vect);
+    uint64_t Cycles = run(F_CPU / 10u);
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getInterruptCount(TIMER2_OVF_vect) - Interrupts, Timer2Dds.getSampleRate() / 10u, 1u));
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getOutputHighCycles(TIMERTWOHOST_CHANNEL_B), Cycles / 2u, Cycles / 50u));
+    Timer2Dds.end();
+}
+#endif
+
+#if TIMERTWO_TONE_VOICES
+/* a voice stops by itself after its duration, a square wave with idle voices averages to the middle level */
+void testTone() {
+    TIMERTWO_TEST_CHECK(Timer2.init(1000u) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.start() == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Tone.begin() == E_OK);
+    uint32_t Interrupts = Timer2Host.getInterruptCount(TIMER2_OVF_vect);
+    run(F_CPU / 10u);
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getInterruptCount(TIMER2_OVF_vect) - Interrupts, Timer2Tone.getSampleRate() / 10u, 1u));
+    TIMERTWO_TEST_CHECK(Timer2Tone.play(0u, 440u, 50u) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Tone.isPlaying(0u));
+    Timer2Host.stepMicroseconds(5000u);
+    Timer2Host.resetOutputStatistics();
+    uint64_t Cycles = run(40000u * (F_CPU / 1000000uL));
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getOutputHighCycles(TIMERTWOHOST_CHANNEL_B), Cycles / 2u, Cycles / 20u));
+    TIMERTWO_TEST_CHECK(Timer2Tone.isPlaying(0u));
+    Timer2Host.stepMicroseconds(10000u);
+    TIMERTWO_TEST_CHECK(!Timer2Tone.isPlaying(0u));
+    TIMERTWO_TEST_CHECK(Timer2Tone.tone(1000u) == E_OK);
+    Timer2Tone.noTone();
+    for(byte Voice = 0u; Voice < TIMERTWO_TONE_VOICES; Voice++) { TIMERTWO_TEST_CHECK(!Timer2Tone.isPlaying(Voice)); }
+    Timer2Tone.end();
+}
+#endif
+
+#if TIMERTWO_PCM
+/* every sample is played for one sample period, the prefetch keeps up with the interrupt and runs once per block in the
+   compare match A interrupt */
+void testPcm() {
+    static byte Samples[1000];
+    memset(Samples, 64, sizeof(Samples));
+
+    uint32_t Prefetches = Timer2Host.getInterruptCount(TIMER2_COMPA_vect);
+    TIMERTWO_TEST_CHECK(Timer2Pcm.begin(8000u) == E_OK);
+    TIMERTWO_TEST_CHECK(isNear(Timer2Pcm.getSampleRate(), 8000u, 8000u / 100u));
+    TIMERTWO_TEST_CHECK(Timer2Pcm.play(Samples, sizeof(Samples)) == E_OK);
+    Timer2Host.stepMicroseconds(10000u);
+    Timer2Host.resetOutputStatistics();
+    uint32_t SampleInterrupts = Timer2Host.getInterruptCount(TIMER2_OVF_vect);
+    uint64_t Cycles = run(50000u * (F_CPU / 1000000uL));
+    SampleInterrupts = Timer2Host.getInterruptCount(TIMER2_OVF_vect) - SampleInterrupts;
+    TIMERTWO_TEST_CHECK(isNear(SampleInterrupts, (Cycles * Timer2Pcm.getSampleRate()) / F_CPU, 1u));
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getOutputHighCycles(TIMERTWOHOST_CHANNEL_B), Cycles / 4u, Cycles / 50u));
+    TIMERTWO_TEST_CHECK(Timer2Pcm.isPlaying());
+    Timer2Host.stepMicroseconds(100000u);
+    TIMERTWO_TEST_CHECK(!Timer2Pcm.isPlaying());
+    TimerTwoPcm::StatisticsType Statistics = Timer2Pcm.getStatistics();
+    TIMERTWO_TEST_CHECK(Statistics.Samples >= sizeof(Samples));
+    TIMERTWO_TEST_CHECK(Statistics.Underruns == 0u);
+    Prefetches = Timer2Host.getInterruptCount(TIMER2_COMPA_vect) - Prefetches;
+    /* the last block of the samples is shorter */
+    TIMERTWO_TEST_CHECK(Prefetches == (Statistics.Samples + TIMERTWO_PCM_BLOCK_SIZE - 1u) / TIMERTWO_PCM_BLOCK_SIZE);
+    TIMERTWO_TEST_CHECK(Statistics.BusyCounts >= Statistics.Samples);
+    TIMERTWO_TEST_CHECK((Timer2Pcm.getLoad() != 0u) && (Timer2Pcm.getLoad() < 100u));
+    Timer2Pcm.end();
+}
+#endif
+
+#if TIMERTWO_PROFILER
+/* output of dump() in memory */
+class TestOutput : public Print
+{
+  public:
+    byte Data[18u + (2u * TIMERTWO_PROFILER_BINS)];
+    size_t Length;
+
+    TestOutput() : Length(0u) { }
+    size_t write(uint8_t Value) { if(Length < sizeof(Data)) { Data[Length++] = Value; return 1u; } return 0u; }
+};
+
+/* every tick is counted in the bin of the interrupted PC, every second one with divider 2 */
+void testProfiler() {
+    const byte Bin = 3u;
+    TIMERTWO_TEST_CHECK(Timer2.init(100u) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.start() == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Profiler.start(0u) == E_NOT_OK);
+    TIMERTWO_TEST_CHECK(Timer2Profiler.start(2u) == E_OK);
+    TimerTwoProfilerPc = TIMERTWO_PROFILER_PC_START + (Bin << TIMERTWO_PROFILER_BIN_SHIFT);
+    Timer2Host.stepMicroseconds(100u * 100u);
+    TimerTwoProfilerPc = static_cast<uint16_t>(TIMERTWO_PROFILER_PC_START - 1u);
+    Timer2Host.stepMicroseconds(100u * 100u);
+    Timer2Profiler.stop();
+    TIMERTWO_TEST_CHECK(isNear(Timer2Profiler.getSamples(), 100u, 1u));
+
+    TestOutput Output;
+    Timer2Profiler.dump(Output);
+    TIMERTWO_TEST_CHECK(Output.Length == sizeof(Output.Data));
+    TIMERTWO_TEST_CHECK(memcmp(Output.Data, TIMERTWOPROFILER_MAGIC, 4u) == 0);
+    /* header of 18 bytes, samples outside of the bins at 14 */
+    uint16_t Count = Output.Data[18u + (2u * Bin)] | (Output.Data[19u + (2u * Bin)] << 8u);
+    uint16_t Outside = Output.Data[14u] | (Output.Data[15u] << 8u);
+    TIMERTWO_TEST_CHECK(isNear(Count, 50u, 1u));
+    TIMERTWO_TEST_CHECK(isNear(Outside, 50u, 1u));
+    Timer2.stop();
+}
+#endif
+
+
+int main() {
+#if TIMERTWO_SOFTPWM_CHANNELS
+    testSoftPwm();
+#endif
+#if TIMERTWO_BAM_ROWS
+    testBam();
+#endif
+#if TIMERTWO_DDS
+    testDds();
+#endif
+#if TIMERTWO_TONE_VOICES
+    testTone();
+#endif
+#if TIMERTWO_PCM
+    testPcm();
+#endif
+#if TIMERTWO_PROFILER
+    testProfiler();
+#endif
+
+    if(Failures != 0u) { printf("mode %u: %u checks failed\n", TIMERTWO_WAVEFORM_MODE, Failures); }
+    return static_cast<int>(Failures);
+}
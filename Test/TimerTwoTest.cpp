@@ -0,0 +1,407 @@
+/*
+ Host test of the TimerTwo library against the Timer2 model of TimerTwoHost.
+ Every check prints the failing condition with file, line and waveform mode,
+ the exit code is the number of failed checks. The waveform mode is selected
+ at compile time, test.sh builds and runs the test for all modes:
+ g++ -std=gnu++11 -I.. -DTIMERTWO_WAVEFORM_MODE=5u ../TimerTwo.cpp ../TimerTwoWheel.cpp ../TimerTwoHost.cpp TimerTwoTest.cpp
+*/
+#include "TimerTwo.h"
+#include "TimerTwoWheel.h"
+#include <stdio.h>
+
+#define TIMERTWO_TEST_CHECK(Condition)                                                                  \
+    do {                                                                                                \
+        if(!(Condition)) {                                                                              \
+            printf("%s:%d: mode %u: %s\n", __FILE__, __LINE__, TIMERTWO_WAVEFORM_MODE, #Condition);     \
+            Failures++;                                                                                 \
+        }                                                                                               \
+    } while(0)
+
+/* timer counts the start of a period may be late by: start() waits for the first timer clock */
+#define TIMERTWO_TEST_START_COUNTS          1u
+/* CPU cycles from BOTTOM to the callback: interrupt response and the register accesses of the tick */
+#define TIMERTWO_TEST_ISR_CYCLES            48u
+/* a new period starts after the current one, which is at most the longest hardware period */
+#define TIMERTWO_TEST_TIMEOUT_CYCLES        (2uL * 510u * 1024u)
+
+static const uint16_t Prescalers[] = { 0u, 1u, 8u, 32u, 64u, 128u, 256u, 1024u };
+/* the phase correct fixed TOP mode has no flag for TOP, read() and the clock are not available */
+static const bool PositionAvailable = !TimerTwoWaveformPolicy::DUAL_SLOPE || TimerTwoWaveformPolicy::TOP_MATCH_FLAG;
+
+static unsigned Failures;
+static unsigned long Ticks;
+static uint64_t TickCycles[2];
+/* CPU cycles the callback takes and the timer counts it measured for them */
+static uint32_t BusyCycles;
+static uint16_t BusyCounts;
+/* wheel ticks at the expiries of the software timers of the wheel tests */
+static TimerTwoWheel::Timer WheelTimers[2];
+static TimerTwoWheel::TickType WheelExpiries[8];
+static byte WheelExpired;
+
+
+void onTick() {
+    TickCycles[0] = TickCycles[1];
+    TickCycles[1] = Timer2Host.getCycles();
+    Ticks++;
+    if(BusyCycles != 0u) {
+        byte StartCount = TCNT2;
+        Timer2Host.step(BusyCycles);
+        BusyCounts = Timer2.getCountsSince(StartCount);
+    }
+}
+
+uint32_t getPrescaler() {
+    return Prescalers[Timer2.getState() == TimerTwo::STATE_RUNNING ? (TCCR2B & 0x07u) : 0u];
+}
+
+uint32_t getPeriodCycles() {
+    return static_cast<uint32_t>((Timer2.getActualPeriodNs() * (F_CPU / 1000000uL) + 500u) / 1000u);
+}
+
+/* run until the next callback, false if it does not come within two periods and the current hardware period */
+bool waitTick() {
+    unsigned long Count = Ticks;
+    uint32_t Timeout = (2u * getPeriodCycles()) + TIMERTWO_TEST_TIMEOUT_CYCLES;
+    while((Ticks == Count) && (Timeout-- != 0u)) { Timer2Host.step(1u); }
+    return Ticks != Count;
+}
+
+bool isNear(uint64_t Value, uint64_t Expected, uint64_t Tolerance) {
+    return (Value + Tolerance >= Expected) && (Value <= Expected + Tolerance);
+}
+
+
+/* the first period after start() has the full length, also with a TOP written while the timer was stopped */
+void testFirstPeriod(TimerTwo::TimeType Microseconds) {
+    Timer2.stop();
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(Microseconds) == E_OK);
+    uint64_t Start = Timer2Host.getCycles();
+    TIMERTWO_TEST_CHECK(Timer2.start() == E_OK);
+    uint32_t Tolerance = (TIMERTWO_TEST_START_COUNTS * getPrescaler()) + TIMERTWO_TEST_ISR_CYCLES;
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(isNear(TickCycles[1] - Start, getPeriodCycles(), Tolerance));
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(isNear(TickCycles[1] - TickCycles[0], getPeriodCycles(), 0u));
+}
+
+
+/* consecutive callbacks are one achieved period apart, which is within the period error of the requested one */
+void testPeriod(TimerTwo::TimeType Microseconds) {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(Microseconds) == E_OK);
+    /* the new TOP becomes active with the next period */
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    for(byte Period = 0u; Period < 4u; Period++) {
+        TIMERTWO_TEST_CHECK(waitTick());
+        TIMERTWO_TEST_CHECK(isNear(TickCycles[1] - TickCycles[0], getPeriodCycles(), 0u));
+    }
+    int32_t ErrorNs = Timer2.getPeriodErrorNs();
+    uint64_t RequestedNs = static_cast<uint64_t>(Microseconds) * 1000u;
+    TIMERTWO_TEST_CHECK(Timer2.getActualPeriodNs() == static_cast<uint64_t>(static_cast<int64_t>(RequestedNs) + ErrorNs));
+}
+
+/* the high time of the compare output is Duty / 256 of the period, one timer count per period of the PWM resolution
+   is tolerated, and one count for the edges of the measurement */
+void testDuty(TimerTwo::PwmPinType Pin, byte Channel, bool Supported, byte Duty) {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(1000u) == E_OK);
+    if(!Supported) {
+        TIMERTWO_TEST_CHECK(Timer2.enablePwm(Pin, Duty) == E_NOT_OK);
+        return;
+    }
+    TIMERTWO_TEST_CHECK(Timer2.enablePwm(Pin, Duty) == E_OK);
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    Timer2Host.resetOutputStatistics();
+    uint64_t Start = Timer2Host.getCycles();
+    for(byte Period = 0u; Period < 8u; Period++) { TIMERTWO_TEST_CHECK(waitTick()); }
+    uint64_t Cycles = Timer2Host.getCycles() - Start;
+    uint64_t Expected = (Cycles * Duty) >> 8u;
+    uint64_t Tolerance = 9u * (getPrescaler() << TimerTwoWaveformPolicy::COUNT_SHIFT);
+    TIMERTWO_TEST_CHECK(isNear(Timer2Host.getOutputHighCycles(Channel), Expected, Tolerance));
+    TIMERTWO_TEST_CHECK(Timer2.disablePwm(Pin) == E_OK);
+}
+
+/* read() returns the time since the last callback, with the resolution of one timer count. Without a flag for TOP the
+   position is unknown, read() does not wait for the counter but fails */
+void testRead(TimerTwo::TimeType Microseconds) {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(Microseconds) == E_OK);
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    if(!PositionAvailable) {
+        TimerTwo::TimeType Elapsed;
+        uint32_t Ticks;
+        uint64_t Start = Timer2Host.getCycles();
+        TIMERTWO_TEST_CHECK(Timer2.read(Elapsed) == E_NOT_OK);
+        TIMERTWO_TEST_CHECK(Timer2.readTicks(Ticks) == E_NOT_OK);
+        TIMERTWO_TEST_CHECK(Timer2Host.getCycles() - Start < TIMERTWO_TEST_ISR_CYCLES);
+        return;
+    }
+    /* the callback runs the interrupt response and the tick after BOTTOM */
+    uint64_t Bottom = TickCycles[1] - TIMERTWO_TEST_ISR_CYCLES / 2u;
+    uint32_t Resolution = (getPrescaler() << TimerTwoWaveformPolicy::COUNT_SHIFT) + TIMERTWO_TEST_ISR_CYCLES;
+    TimerTwo::TimeType Last = 0u;
+    for(byte Step = 1u; Step < 8u; Step++) {
+        Timer2Host.step(static_cast<uint32_t>(Bottom + ((static_cast<uint64_t>(getPeriodCycles()) * Step) >> 3u) - Timer2Host.getCycles()));
+        TimerTwo::TimeType Elapsed;
+        TIMERTWO_TEST_CHECK(Timer2.read(Elapsed) == E_OK);
+        uint64_t ElapsedCycles = static_cast<uint64_t>(Elapsed) * (F_CPU / 1000000uL);
+        TIMERTWO_TEST_CHECK(isNear(ElapsedCycles, Timer2Host.getCycles() - Bottom, Resolution + (F_CPU / 1000000uL)));
+        TIMERTWO_TEST_CHECK(Elapsed >= Last);
+        Last = Elapsed;
+    }
+}
+
+/* getCountsSince() measures a callback across TOP, in phase correct mode also on the way down to BOTTOM. The
+   callback has to end within the hardware period, without the compare match flag of TOP even before TOP */
+void testCountsSince(TimerTwo::TimeType Microseconds, byte Percent) {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(Microseconds) == E_OK);
+    if((Timer2.getPostscaler() != 1u) || (TimerTwoWaveformPolicy::DUAL_SLOPE && !TimerTwoWaveformPolicy::TOP_MATCH_FLAG && (Percent >= 50u))) { return; }
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    uint32_t Busy = (getPeriodCycles() / 100u) * Percent;
+    BusyCycles = Busy;
+    TIMERTWO_TEST_CHECK(waitTick());
+    BusyCycles = 0u;
+    uint32_t CountCycles = getPrescaler();
+    TIMERTWO_TEST_CHECK(isNear(static_cast<uint64_t>(BusyCounts) * CountCycles, Busy, 2u * CountCycles));
+}
+
+/* an update committed while stopped is active after resume(), the clock follows the hardware without drift */
+void testResumeUpdate(TimerTwo::TimeType Microseconds, TimerTwo::TimeType NewMicroseconds) {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(Microseconds) == E_OK);
+    TIMERTWO_TEST_CHECK(waitTick());
+    Timer2Host.step(getPeriodCycles() / 3u);
+    Timer2.stop();
+    TIMERTWO_TEST_CHECK(Timer2.stagePeriod(NewMicroseconds) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.commitUpdate() == E_OK);
+    TIMERTWO_TEST_CHECK(!Timer2.isUpdatePending());
+    TIMERTWO_TEST_CHECK(Timer2.resume() == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.getState() == TimerTwo::STATE_RUNNING);
+
+    /* the rest of the stopped period, then full periods of the new length */
+    TIMERTWO_TEST_CHECK(waitTick());
+    uint32_t TicksStart = 0u;
+    StdReturnType ClockReadable = Timer2.readTicks(TicksStart);
+    TIMERTWO_TEST_CHECK((E_OK == ClockReadable) == PositionAvailable);
+    uint64_t CyclesStart = Timer2Host.getCycles();
+    for(byte Period = 0u; Period < 8u; Period++) {
+        TIMERTWO_TEST_CHECK(waitTick());
+        TIMERTWO_TEST_CHECK(isNear(TickCycles[1] - TickCycles[0], getPeriodCycles(), 0u));
+    }
+    uint32_t TicksEnd = 0u;
+    TIMERTWO_TEST_CHECK(Timer2.readTicks(TicksEnd) == ClockReadable);
+    if(E_OK == ClockReadable) { TIMERTWO_TEST_CHECK(isNear(TicksEnd - TicksStart, Timer2Host.getCycles() - CyclesStart, getPrescaler())); }
+}
+
+
+/* the compile time setPeriod<>() takes the same path as setPeriod(): not while an update is pending, the longest hardware
+   period is accepted */
+void testTemplatePeriod() {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(1000u) == E_OK);
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(Timer2.stagePeriod(500u) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.commitUpdate() == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.isUpdatePending());
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod<250u>() == E_NOT_OK);
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(250u) == E_NOT_OK);
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(!Timer2.isUpdatePending());
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod<TimerTwo::getPeriodMax()>() == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2.getPostscaler() == 1u);
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod<250u>() == E_OK);
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(waitTick());
+    TIMERTWO_TEST_CHECK(isNear(TickCycles[1] - TickCycles[0], getPeriodCycles(), 0u));
+    TIMERTWO_TEST_CHECK(Timer2.getActualPeriodNs() == TimerTwoConfig<250u>::ActualPeriodNs);
+}
+
+/* the wheel tests tick the wheel with the Timer2 period, so they replace the callback of the other tests */
+void onWheelExpiry() {
+    if(WheelExpired < sizeof(WheelExpiries) / sizeof(WheelExpiries[0])) { WheelExpiries[WheelExpired] = Timer2Wheel.getTicks(); }
+    WheelExpired++;
+}
+
+void onWheelStopOther0() {
+    onWheelExpiry();
+    Timer2Wheel.stopTimer(WheelTimers[1]);
+}
+
+void onWheelStopOther1() {
+    onWheelExpiry();
+    Timer2Wheel.stopTimer(WheelTimers[0]);
+}
+
+void onWheelStopSelf() {
+    onWheelExpiry();
+    if(2u == WheelExpired) { Timer2Wheel.stopTimer(WheelTimers[0]); }
+}
+
+/* a quarter of the hardware period, the phase correct fixed TOP mode measures only up to TOP */
+uint32_t getWheelBusyCycles() {
+    return getPeriodCycles() / Timer2.getPostscaler() / 4u;
+}
+
+void onWheelBusy() {
+    onWheelExpiry();
+    Timer2Host.step(getWheelBusyCycles());
+}
+
+/* run the model until the wheel processed Count more ticks */
+bool runWheelTicks(TimerTwoWheel::TickType Count) {
+    TimerTwoWheel::TickType Start = Timer2Wheel.getTicks();
+    while(static_cast<TimerTwoWheel::TickType>(Timer2Wheel.getTicks() - Start) < Count) {
+        uint32_t Timeout = (2u * getPeriodCycles()) + TIMERTWO_TEST_TIMEOUT_CYCLES;
+        TimerTwoWheel::TickType Ticks = Timer2Wheel.getTicks();
+        while((Timer2Wheel.getTicks() == Ticks) && (Timeout-- != 0u)) { Timer2Host.step(1u); }
+        if(Timer2Wheel.getTicks() == Ticks) { return false; }
+    }
+    return true;
+}
+
+/* start a timer, the wheel tick of its first expiry is the returned start tick + Delay */
+TimerTwoWheel::TickType startWheelTimer(byte Index, TimerTwoWheel::TickType Delay, TimerTwoWheel::TickType Period,
+                                        TimerTwoWheel::TimerCallbackF_void Callback) {
+    /* no wheel tick between reading the ticks and starting the timer */
+    uint8_t SregSave = SREG;
+    cli();
+    TimerTwoWheel::TickType Start = Timer2Wheel.getTicks();
+    TIMERTWO_TEST_CHECK(Timer2Wheel.startTimer(WheelTimers[Index], Delay, Period, Callback) == E_OK);
+    SREG = SregSave;
+    return Start;
+}
+
+/* a one shot timer expires exactly Delay ticks after its start, not earlier, also after the cascades of the higher levels.
+   Offset moves the start away from the slot boundaries of level 0 */
+void testWheelDelay(TimerTwoWheel::TickType Delay, TimerTwoWheel::TickType Offset) {
+    TIMERTWO_TEST_CHECK(runWheelTicks(Offset));
+    WheelExpired = 0u;
+    TimerTwoWheel::TickType Start = startWheelTimer(0u, Delay, 0u, onWheelExpiry);
+    TIMERTWO_TEST_CHECK(runWheelTicks(Delay - 1u));
+    TIMERTWO_TEST_CHECK(0u == WheelExpired);
+    TIMERTWO_TEST_CHECK(WheelTimers[0].isActive());
+    TIMERTWO_TEST_CHECK(runWheelTicks(2u));
+    TIMERTWO_TEST_CHECK(1u == WheelExpired);
+    TIMERTWO_TEST_CHECK(static_cast<TimerTwoWheel::TickType>(Start + Delay) == WheelExpiries[0]);
+    TIMERTWO_TEST_CHECK(!WheelTimers[0].isActive());
+}
+
+/* a periodic timer is re-armed with its period after each expiry, also across level 0 and level 1 */
+void testWheelPeriodic(TimerTwoWheel::TickType Delay, TimerTwoWheel::TickType Period) {
+    WheelExpired = 0u;
+    TimerTwoWheel::TickType Start = startWheelTimer(0u, Delay, Period, onWheelExpiry);
+    TIMERTWO_TEST_CHECK(runWheelTicks(Delay + (3u * Period)));
+    TIMERTWO_TEST_CHECK(4u == WheelExpired);
+    for(byte Expiry = 0u; Expiry < 4u; Expiry++) {
+        TIMERTWO_TEST_CHECK(static_cast<TimerTwoWheel::TickType>(Start + Delay + (Expiry * Period)) == WheelExpiries[Expiry]);
+    }
+    TIMERTWO_TEST_CHECK(WheelTimers[0].isActive());
+    Timer2Wheel.stopTimer(WheelTimers[0]);
+    TIMERTWO_TEST_CHECK(!WheelTimers[0].isActive());
+    TIMERTWO_TEST_CHECK(runWheelTicks(2u * Period));
+    TIMERTWO_TEST_CHECK(4u == WheelExpired);
+}
+
+/* of two periodic timers expiring in the same tick the first callback stops the other timer, which is not called anymore.
+   The order of the callbacks is not specified, so each callback stops the other timer */
+void testWheelStopOther(TimerTwoWheel::TickType Delay) {
+    WheelExpired = 0u;
+    TimerTwoWheel::TickType Start = startWheelTimer(0u, Delay, 5u, onWheelStopOther0);
+    startWheelTimer(1u, Delay, 5u, onWheelStopOther1);
+    TIMERTWO_TEST_CHECK(runWheelTicks(Delay));
+    TIMERTWO_TEST_CHECK(1u == WheelExpired);
+    TIMERTWO_TEST_CHECK(static_cast<TimerTwoWheel::TickType>(Start + Delay) == WheelExpiries[0]);
+    TIMERTWO_TEST_CHECK(WheelTimers[0].isActive() != WheelTimers[1].isActive());
+    /* only the other timer expires further */
+    TIMERTWO_TEST_CHECK(runWheelTicks(5u));
+    TIMERTWO_TEST_CHECK(2u == WheelExpired);
+    TIMERTWO_TEST_CHECK(static_cast<TimerTwoWheel::TickType>(Start + Delay + 5u) == WheelExpiries[1]);
+    Timer2Wheel.stopTimer(WheelTimers[0]);
+    Timer2Wheel.stopTimer(WheelTimers[1]);
+}
+
+/* a periodic timer stops itself in its second callback */
+void testWheelStopSelf() {
+    WheelExpired = 0u;
+    TimerTwoWheel::TickType Start = startWheelTimer(0u, 3u, 7u, onWheelStopSelf);
+    TIMERTWO_TEST_CHECK(runWheelTicks(40u));
+    TIMERTWO_TEST_CHECK(2u == WheelExpired);
+    TIMERTWO_TEST_CHECK(static_cast<TimerTwoWheel::TickType>(Start + 10u) == WheelExpiries[1]);
+    TIMERTWO_TEST_CHECK(!WheelTimers[0].isActive());
+}
+
+/* a timer stopped after it cascaded from level 2 does not expire, the other timer of its slot list still does */
+void testWheelStopCascaded() {
+    WheelExpired = 0u;
+    TimerTwoWheel::TickType Start = startWheelTimer(1u, 300u, 0u, onWheelExpiry);
+    startWheelTimer(0u, 300u, 0u, onWheelExpiry);
+    /* after 256 ticks both timers are below level 2 */
+    TIMERTWO_TEST_CHECK(runWheelTicks(290u));
+    Timer2Wheel.stopTimer(WheelTimers[0]);
+    TIMERTWO_TEST_CHECK(!WheelTimers[0].isActive());
+    TIMERTWO_TEST_CHECK(runWheelTicks(20u));
+    TIMERTWO_TEST_CHECK(1u == WheelExpired);
+    TIMERTWO_TEST_CHECK(static_cast<TimerTwoWheel::TickType>(Start + 300u) == WheelExpiries[0]);
+    TIMERTWO_TEST_CHECK(!WheelTimers[1].isActive());
+}
+
+/* the tick cost covers the callbacks, a busy callback is measured in timer counts */
+void testWheelTickCost() {
+    WheelExpired = 0u;
+    Timer2Wheel.resetTickCost();
+    startWheelTimer(0u, 2u, 0u, onWheelBusy);
+    startWheelTimer(1u, 2u, 0u, onWheelExpiry);
+    TIMERTWO_TEST_CHECK(runWheelTicks(3u));
+    TIMERTWO_TEST_CHECK(2u == WheelExpired);
+    TimerTwoWheel::TickCostType Cost = Timer2Wheel.getTickCost();
+    uint32_t CountCycles = getPrescaler();
+    TIMERTWO_TEST_CHECK(Cost.Max != 0u);
+    TIMERTWO_TEST_CHECK(isNear(static_cast<uint64_t>(Cost.Max) * CountCycles, getWheelBusyCycles(), (2u * CountCycles) + TIMERTWO_TEST_ISR_CYCLES));
+    TIMERTWO_TEST_CHECK(2u == Cost.ExpiredMax);
+}
+
+void testWheel() {
+    TIMERTWO_TEST_CHECK(Timer2.setPeriod(50u) == E_OK);
+    TIMERTWO_TEST_CHECK(Timer2Wheel.init() == E_OK);
+    testWheelDelay(1u, 5u);
+    testWheelDelay(17u, 3u);
+    testWheelDelay(300u, 9u);
+    testWheelDelay(5000u, 11u);
+    testWheelPeriodic(3u, 5u);
+    testWheelPeriodic(10u, 40u);
+    testWheelStopOther(5u);
+    testWheelStopOther(20u);
+    testWheelStopSelf();
+    testWheelStopCascaded();
+    testWheelTickCost();
+}
+
+int main() {
+    TIMERTWO_TEST_CHECK(Timer2.init(1000u, onTick) == E_OK);
+    testFirstPeriod(1000u);
+    testFirstPeriod(100u);
+    testFirstPeriod(4000u);
+    testResumeUpdate(1000u, 250u);
+    testResumeUpdate(250u, 4000u);
+    testPeriod(20u);
+    testPeriod(250u);
+    testPeriod(1000u);
+    testPeriod(16000u);
+    testPeriod(100000u);
+    testDuty(TimerTwo::PWM_PIN_3, TIMERTWOHOST_CHANNEL_B, TimerTwoWaveformPolicy::PWM_B_SUPPORTED, 64u);
+    testDuty(TimerTwo::PWM_PIN_3, TIMERTWOHOST_CHANNEL_B, TimerTwoWaveformPolicy::PWM_B_SUPPORTED, 192u);
+    testDuty(TimerTwo::PWM_PIN_11, TIMERTWOHOST_CHANNEL_A, TimerTwoWaveformPolicy::PWM_A_SUPPORTED, 128u);
+    testRead(1000u);
+    testRead(4000u);
+    testRead(100000u);
+    testCountsSince(1000u, 30u);
+    testCountsSince(1000u, 70u);
+    testCountsSince(250u, 90u);
+    testTemplatePeriod();
+    testWheel();
+
+    if(Failures != 0u) { printf("mode %u: %u checks failed\n", TIMERTWO_WAVEFORM_MODE, Failures); }
+    return static_cast<int>(Failures);
+}
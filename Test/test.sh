@@ -0,0 +1,42 @@
+#!/bin/sh
+# Host test of the TimerTwo library, builds TimerTwoTest.cpp with g++ for every waveform mode and TimerTwoModuleTest.cpp
+# for every module in the waveform mode it needs, and runs them. All sources of the library are built every time.
+#
+# usage: test.sh
+# environment: MODES (default "0 1 2 3 5 7"), CXX (default g++),
+#              MODULES (mode:defines pairs, the defines separated by commas, default every module)
+
+SCRIPT_DIR=$(cd "$(dirname "$0")" && pwd)
+LIBRARY_DIR=$(cd "$SCRIPT_DIR/.." && pwd)
+BUILD_DIR=${TMPDIR:-/tmp}/timertwo-test
+MODES=${MODES:-"0 1 2 3 5 7"}
+MODULES=${MODULES:-"2:TIMERTWO_SOFTPWM_CHANNELS=4u 0:TIMERTWO_SOFTPWM_CHANNELS=24u 2:TIMERTWO_BAM_ROWS=2u,TIMERTWO_BAM_COLUMNS=4u
+    3:TIMERTWO_DDS=1 1:TIMERTWO_DDS=1 3:TIMERTWO_TONE_VOICES=4u 1:TIMERTWO_TONE_VOICES=8u
+    3:TIMERTWO_TONE_VOICES=2u,F_CPU=20000000uL 7:TIMERTWO_PCM=1 5:TIMERTWO_PROFILER=1"}
+CXX=${CXX:-g++}
+FAILED=""
+
+# build and run a test: name of the test, source of the test, waveform mode, further compiler flags
+run() {
+    if "$CXX" -std=gnu++11 -Wall -Wextra -I"$LIBRARY_DIR" -DTIMERTWO_WAVEFORM_MODE=${3}u $4 \
+            "$LIBRARY_DIR"/TimerTwo*.cpp "$2" -o "$BUILD_DIR/$1" && "$BUILD_DIR/$1"; then
+        echo "$1: passed"
+    else
+        FAILED="$FAILED $1"
+    fi
+}
+
+mkdir -p "$BUILD_DIR"
+for MODE in $MODES; do
+    run "TimerTwoTest-$MODE" "$SCRIPT_DIR/TimerTwoTest.cpp" "$MODE" ""
+done
+for MODULE in $MODULES; do
+    MODE=${MODULE%%:*}
+    DEFINES=$(echo "${MODULE#*:}" | sed 's/^/-D/; s/,/ -D/g')
+    run "TimerTwoModuleTest-$MODE-$(echo "${MODULE#*:}" | sed 's/=.*//; s/^TIMERTWO_//')" "$SCRIPT_DIR/TimerTwoModuleTest.cpp" "$MODE" "$DEFINES"
+done
+
+if [ -n "$FAILED" ]; then
+    echo "failed:$FAILED"
+    exit 1
+fi
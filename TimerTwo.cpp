@@ -21,6 +21,8 @@
  * INCLUDES
  *****************************************************************************************************************************************************/
 #include "TimerTwo.h"
+#include "TimerTwoProfiler.h"
+#include "TimerTwoTone.h"
 
 
 /******************************************************************************************************************************************************
@@ -45,7 +47,40 @@ TimerTwo::TimerTwo()
 {
     State = STATE_INIT;
     TimerIsrOverflowCallback = nullptr;
+    TimerIsrContextCallback = nullptr;
+    TimerIsrCallbackContext = nullptr;
+    TimerIsrElapsedCallback = nullptr;
+    ElapsedTicks = 0u;
+    ElapsedCallbackActive = false;
+    OverrunStatistics.Overruns = 0u;
+    OverrunStatistics.MissedTicks = 0u;
+    StopwatchOverhead = 0u;
+    DeferredHead = 0u;
+    DeferredTail = 0u;
+    DeferredStatistics.Overflows = 0u;
+    DeferredStatistics.HighWaterMark = 0u;
+#if TIMERTWO_STATISTICS
+    resetStats();
+#endif
     ClockSelectBitGroup = REG_CS_NO_CLOCK;
+    ClockTicksLow = 0u;
+    ClockTicksHigh = 0u;
+    PeriodCycles = 0u;
+    PeriodMicroseconds = 0u;
+    Postscaler = 1u;
+    PostscalerCount = 1u;
+    Dithering = false;
+    DitherState.Top = 0u;
+    DitherState.Fraction = 0u;
+    DitherState.Denominator = 1u;
+    DitherState.Accumulator = 0u;
+    DitherStepCycles = 0u;
+    DitherLongActive = false;
+    DitherLongPending = false;
+    Update.Mask = 0u;
+    Update.DutyCycleA = 0u;
+    Update.DutyCycleB = 0u;
+    UpdateState = UPDATE_IDLE;
 } /* TimerTwo */
 
 
@@ -90,14 +125,9 @@ StdReturnType TimerTwo::init(TimeType Microseconds, TimerIsrCallbackF_void sTime
 
     if(STATE_INIT == State) {
         ReturnValue = E_OK;
-        /* clear control register */
-        TCCR2A = 0u;
-        TCCR2B = 0u;
-        
-        /* set mode 5: phase correct PWM */
-        writeBit(TCCR2A, WGM20, 1u);
-        writeBit(TCCR2A, WGM21, 0u);
-        writeBit(TCCR2B, WGM22, 1u);
+        /* set waveform generation mode selected by TIMERTWO_WAVEFORM_MODE, compare outputs and clock are off */
+        Reg::Tccr2a::write<Reg::Wgm2a::Value<(WaveformPolicy::WGM & Reg::Wgm2a::MAX)> >();
+        Reg::Tccr2b::write<Reg::Wgm2b::Value<(WaveformPolicy::WGM >> 2u)>, Reg::Cs2::Value<REG_CS_NO_CLOCK> >();
         
         if(setPeriod(Microseconds) == E_NOT_OK) { ReturnValue = E_NOT_OK; }
         if(sTimerOverflowCallback != nullptr) { attachInterrupt(sTimerOverflowCallback); }
@@ -107,34 +137,301 @@ StdReturnType TimerTwo::init(TimeType Microseconds, TimerIsrCallbackF_void sTime
 } /* init */
 
 
+/******************************************************************************************************************************************************
+  initStopwatch()
+******************************************************************************************************************************************************/
+/*! \brief          initialize and start Timer2 as cycle counter for TimerTwo::Stopwatch
+ *  \details        Timer2 runs without prescaler and with TOP 0xFF, so the counter counts CPU cycles and the overflow
+ *                  interrupt extends it every 256 cycles. The cost of an empty measurement is measured once and
+ *                  subtracted by the stopwatch. Best used with TIMERTWO_MODE_NORMAL, the other single slope modes work
+ *                  as well. A callback can be attached, it is called every 256 CPU cycles. The tick interrupt takes
+ *                  about 100 of every 256 cycles and is included in the measurements, TIMERTWO_STOPWATCH_ISR() replaces
+ *                  it with one which only extends the counter.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is already initialized or the waveform mode is dual slope
+ *  \pre            Timer has to be in INIT state
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::initStopwatch()
+{
+    if(WaveformPolicy::DUAL_SLOPE || (init() == E_NOT_OK)) { return E_NOT_OK; }
+
+    /* overflow interrupt is not enabled yet, no need to protect the shared data */
+    if(!WaveformPolicy::FIXED_TOP) { OCR2A = TimerTwoPeriodSolver::TOP_MAX; }
+    ClockSelectBitGroup = REG_CS_NO_PRESCALER;
+    PeriodMicroseconds = TIMERTWO_RESOLUTION / (F_CPU / 1000000uL);
+    PeriodCycles = TIMERTWO_RESOLUTION;
+    DitherStepCycles = 1u;
+    Postscaler = 1u;
+    PostscalerCount = 1u;
+    if(start() == E_NOT_OK) { return E_NOT_OK; }
+
+    /* the shortest of some empty measurements, so an interrupt does not disturb the calibration */
+    Stopwatch Calibration;
+    uint32_t Overhead = UINT32_MAX;
+    for(byte Run = 0u; Run < 4u; Run++) {
+        Calibration.start();
+        uint32_t Cycles = Calibration.elapsedCycles();
+        if(Cycles < Overhead) { Overhead = Cycles; }
+    }
+    StopwatchOverhead = static_cast<byte>(Overhead);
+    return E_OK;
+} /* initStopwatch */
+
+
 /******************************************************************************************************************************************************
   setPeriod()
 ******************************************************************************************************************************************************/
 /*! \brief          set period of Timer2 overflow interrupt
  *  \details        this functions sets the period of the Timer2 overflow interrupt therefore 
- *                  prescaler and timer top value will be calculated
+ *                  prescaler and timer top value will be calculated. Periods greater than getPeriodMax() are split into
+ *                  several hardware periods, the callback is called by a software postscaler.
  *  \param[in]      Microseconds                period of the timer overflow interrupt
  *  \return         E_OK
- *                  E_NOT_OK - Given period is out of bound
+ *                  E_NOT_OK - Given period is out of bound or staged update still pending
  *****************************************************************************************************************************************************/
 StdReturnType TimerTwo::setPeriod(TimeType Microseconds)
 {
     StdReturnType ReturnValue{E_NOT_OK};
 
-    if(Microseconds <= getPeriodMax()) {
-        /* OCR2A is TOP in phase correct PWM mode */
-        OCR2A = getTimerCycles(Microseconds);
+    if((Microseconds <= getPostscaledPeriodMax()) && !isUpdatePending()) {
+        uint16_t NewPostscaler;
+        DitherStateType NewDitherState = DitherState;
+        ClockSelectType NewClockSelect;
+        byte Top;
 
-        if(STATE_RUNNING == State) {
-            /* reset clock select register, and start the clock */
-            writeBitGroup(TCCR2B, TIMERTWO_REG_CS_GM, TIMERTWO_REG_CS_GP, ClockSelectBitGroup);                     
+        if(Dithering) {
+            if(getDitherCycles(Microseconds, NewPostscaler, NewDitherState, NewClockSelect) == E_NOT_OK) { return E_NOT_OK; }
+            Top = NewDitherState.Top;
+        } else {
+            Top = getTimerCycles(Microseconds, NewPostscaler, NewClockSelect);
         }
+        applyPeriod(Top, NewClockSelect, NewPostscaler, Microseconds, NewDitherState);
         return E_OK;
     }
     return ReturnValue;
 } /* setPeriod */
 
 
+/******************************************************************************************************************************************************
+  getActualPeriodNs()
+******************************************************************************************************************************************************/
+/*! \brief          get achieved period of Timer2 overflow interrupt
+ *  \details        the period can only be set in steps of 2 * prescaler CPU cycles in phase correct mode and of prescaler
+ *                  CPU cycles in CTC and fast PWM mode. This function returns the period
+ *                  which is really generated by the hardware, multiplied by the postscaler. With dithering enabled the
+ *                  average period is returned.
+ *
+ *  \return         achieved period in nanoseconds
+ *****************************************************************************************************************************************************/
+uint64_t TimerTwo::getActualPeriodNs()
+{
+    uint64_t Cycles;
+    uint8_t SregSave = SREG;
+    cli();
+    if(Dithering) {
+        /* average period: Postscaler * (Top + Fraction / Denominator) * Step with Denominator = Postscaler * Step */
+        Cycles = ((static_cast<uint64_t>(DitherState.Top) + WaveformPolicy::TOP_OFFSET) * DitherState.Denominator) + DitherState.Fraction;
+    } else {
+        Cycles = static_cast<uint64_t>(PeriodCycles) * Postscaler;
+    }
+    SREG = SregSave;
+    return TimerTwoPeriodSolver::nanoseconds(Cycles);
+} /* getActualPeriodNs */
+
+
+/******************************************************************************************************************************************************
+  getPeriodErrorNs()
+******************************************************************************************************************************************************/
+/*! \brief          get error of the achieved period
+ *  \details        
+ *
+ *  \return         achieved period minus requested period in nanoseconds
+ *****************************************************************************************************************************************************/
+int32_t TimerTwo::getPeriodErrorNs()
+{
+    return static_cast<int32_t>(static_cast<int64_t>(getActualPeriodNs()) - (static_cast<int64_t>(PeriodMicroseconds) * 1000));
+} /* getPeriodErrorNs */
+
+
+/******************************************************************************************************************************************************
+  stagePeriod()
+******************************************************************************************************************************************************/
+/*! \brief          stage a new period
+ *  \details        prescaler, TOP and postscaler are calculated like setPeriod() does, but only stored in the shadow values.
+ *                  Nothing changes until commitUpdate() is called.
+ *
+ *  \param[in]      Microseconds                period of the timer overflow interrupt
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not initialized, dithering is enabled, last update still pending or
+ *                             period is out of bound
+ *  \pre            Timer has to be in READY, RUNNING or STOPPED state
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::stagePeriod(TimeType Microseconds)
+{
+    if(((STATE_IDLE == State) || (STATE_RUNNING == State) || (STATE_STOPPED == State)) && !Dithering && !isUpdatePending()) {
+        if(Microseconds <= getPostscaledPeriodMax()) {
+            /* the interrupt does not access the shadow values while no update is pending */
+            Update.Top = getTimerCycles(Microseconds, Update.Postscaler, Update.ClockSelectBitGroup);
+            Update.PeriodCycles = TimerTwoPeriodSolver::periodCycles(Update.Top, Update.ClockSelectBitGroup - 1u);
+            Update.PeriodMicroseconds = Microseconds;
+            Update.Mask |= TIMERTWO_UPDATE_PERIOD;
+            return E_OK;
+        }
+    }
+    return E_NOT_OK;
+} /* stagePeriod */
+
+
+/******************************************************************************************************************************************************
+  stagePwmDuty()
+******************************************************************************************************************************************************/
+/*! \brief          stage a new pwm duty cycle
+ *  \details        the compare value is calculated by commitUpdate(), so it is related to the staged TOP value
+ *
+ *  \param[in]      PwmPin                  pin where pwm duty cycle should be set
+ *  \param[in]      DutyCycle               duty cycle of pwm
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not initialized, last update still pending or PwmPin is not supported
+ *  \pre            Timer has to be in READY, RUNNING or STOPPED state
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::stagePwmDuty(PwmPinType PwmPin, byte DutyCycle)
+{
+    if(((STATE_IDLE == State) || (STATE_RUNNING == State) || (STATE_STOPPED == State)) && !isUpdatePending()) {
+        if((PWM_PIN_3 == PwmPin) && WaveformPolicy::PWM_B_SUPPORTED) {
+            Update.DutyCycleB = DutyCycle;
+            Update.Mask |= TIMERTWO_UPDATE_DUTY_B;
+            return E_OK;
+        }
+        if((PWM_PIN_11 == PwmPin) && WaveformPolicy::PWM_A_SUPPORTED) {
+            Update.DutyCycleA = DutyCycle;
+            Update.Mask |= TIMERTWO_UPDATE_DUTY_A;
+            return E_OK;
+        }
+    }
+    return E_NOT_OK;
+} /* stagePwmDuty */
+
+
+/******************************************************************************************************************************************************
+  commitUpdate()
+******************************************************************************************************************************************************/
+/*! \brief          apply the staged period and duty cycles at the next BOTTOM
+ *  \details        the overflow interrupt writes the compare registers at the next BOTTOM. Double buffered compare
+ *                  registers are latched by the hardware one period later, so the prescaler and the period of the clock
+ *                  and the postscaler are switched at the following BOTTOM. Like this the period and the duty cycles
+ *                  change together at a period boundary. If the clock is stopped the update is applied at once, the
+ *                  compare registers are latched by writing them in normal mode.
+ *                  isUpdatePending() returns true until the update is complete, no new update can be staged meanwhile.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not initialized, dithering is enabled, nothing staged or last update still pending
+ *  \pre            Timer has to be in READY, RUNNING or STOPPED state
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::commitUpdate()
+{
+    if(((STATE_IDLE == State) || (STATE_RUNNING == State) || (STATE_STOPPED == State)) && !Dithering && !isUpdatePending()) {
+        if(Update.Mask != 0u) {
+            /* duty cycles are related to the new TOP, so the interrupt only has to copy the values */
+            byte Top = WaveformPolicy::FIXED_TOP ? TimerTwoPeriodSolver::TOP_MAX : ((Update.Mask & TIMERTWO_UPDATE_PERIOD) ? Update.Top : OCR2A);
+            Update.OcrA = WaveformPolicy::duty(Top, Update.DutyCycleA);
+            Update.OcrB = WaveformPolicy::duty(Top, Update.DutyCycleB);
+
+            uint8_t SregSave = SREG;
+            cli();
+            UpdateState = UPDATE_PENDING;
+            if(!isClockRunning()) {
+                /* no interrupt at BOTTOM, apply both phases now, the clock select register is written by start() or resume() */
+                updateShadowRegisters();
+                if(isUpdatePending()) { updateShadowRegisters(); }
+                latchCompareRegisters();
+            }
+            SREG = SregSave;
+            return E_OK;
+        }
+    }
+    return E_NOT_OK;
+} /* commitUpdate */
+
+
+/******************************************************************************************************************************************************
+  enableDithering()
+******************************************************************************************************************************************************/
+/*! \brief          enable dithering of the TOP value
+ *  \details        OCR2A alternates between two adjacent TOP values, controlled by a phase accumulator which is updated at
+ *                  every BOTTOM. So the average period equals the requested period exactly, the jitter of a single period
+ *                  is one TOP step. The prescaler with the finest step is used. Note that the PWM
+ *                  duty cycle is not adjusted to the alternating TOP value. Not available in the fixed TOP modes.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not initialized, fixed TOP mode, update pending or period can not be dithered
+ *  \pre            Timer has to be in READY, RUNNING or STOPPED state
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::enableDithering()
+{
+    if(((STATE_IDLE == State) || (STATE_RUNNING == State) || (STATE_STOPPED == State)) && !WaveformPolicy::FIXED_TOP && !isUpdatePending()) {
+        uint16_t NewPostscaler;
+        DitherStateType NewDitherState;
+        ClockSelectType NewClockSelect;
+
+        if(getDitherCycles(PeriodMicroseconds, NewPostscaler, NewDitherState, NewClockSelect) == E_OK) {
+            /* the overflow interrupt must not see the flag before the dither state is valid */
+            uint8_t SregSave = SREG;
+            cli();
+            DitherState = NewDitherState;
+            DitherLongActive = false;
+            DitherLongPending = false;
+            Dithering = true;
+            SREG = SregSave;
+            return setPeriod(PeriodMicroseconds);
+        }
+    }
+    return E_NOT_OK;
+} /* enableDithering */
+
+
+/******************************************************************************************************************************************************
+  disableDithering()
+******************************************************************************************************************************************************/
+/*! \brief          disable dithering of the TOP value
+ *  \details        the period is calculated again by the error minimizing solver
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not initialized
+ *  \pre            Timer has to be in READY, RUNNING or STOPPED state
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::disableDithering()
+{
+    if((STATE_IDLE == State) || (STATE_RUNNING == State) || (STATE_STOPPED == State)) {
+        uint8_t SregSave = SREG;
+        cli();
+        Dithering = false;
+        SREG = SregSave;
+        return setPeriod(PeriodMicroseconds);
+    }
+    return E_NOT_OK;
+} /* disableDithering */
+
+
+/******************************************************************************************************************************************************
+  getDitherState()
+******************************************************************************************************************************************************/
+/*! \brief          get state of the TOP dithering
+ *  \details        the exact TOP value is Top + Fraction / Denominator, Accumulator is the current remainder of the
+ *                  phase accumulator
+ *
+ *  \return         dither state
+ *****************************************************************************************************************************************************/
+TimerTwo::DitherStateType TimerTwo::getDitherState()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    DitherStateType CurrentState = DitherState;
+    SREG = SregSave;
+    return CurrentState;
+} /* getDitherState */
+
+
 /******************************************************************************************************************************************************
   enablePwm()
 ******************************************************************************************************************************************************/
@@ -144,7 +441,7 @@ StdReturnType TimerTwo::setPeriod(TimeType Microseconds)
  *  \param[in]      PwmPin                  pin where pwm should be enabled
  *  \param[in]      DutyCycle               duty cycle of pwm
  *  \return         E_OK
- *                  E_NOT_OK - TimerTwo is not initialized or wrong PwmPin was given
+ *                  E_NOT_OK - TimerTwo is not initialized or PwmPin is not supported by the waveform mode
  *  \pre            Timer has to be in READY, RUNNING or STOPPED state
  *****************************************************************************************************************************************************/
 StdReturnType TimerTwo::enablePwm(PwmPinType PwmPin, byte DutyCycle) 
@@ -153,11 +450,18 @@ StdReturnType TimerTwo::enablePwm(PwmPinType PwmPin, byte DutyCycle)
 
     if((STATE_IDLE == State) || (STATE_RUNNING == State) || (STATE_STOPPED == State))
     {   
-        if(PWM_PIN_3 == PwmPin) {
+        /* CTC mode has no PWM output */
+        if((PWM_PIN_3 == PwmPin) && WaveformPolicy::PWM_B_SUPPORTED) {
             ReturnValue = E_OK;
             pinMode(PWM_PIN_3, OUTPUT);
             /* activate compare output mode in timer control register */
-            writeBit(TCCR2A, COM2B1, 1u);
+            Reg::Com2b::write<Reg::COM_NON_INVERTING>();
+        }
+        /* pin 11 only in the fixed TOP modes, otherwise OCR2A is TOP */
+        if((PWM_PIN_11 == PwmPin) && WaveformPolicy::PWM_A_SUPPORTED) {
+            ReturnValue = E_OK;
+            pinMode(PWM_PIN_11, OUTPUT);
+            Reg::Com2a::write<Reg::COM_NON_INVERTING>();
         }
 
         if(setPwmDuty(PwmPin, DutyCycle) == E_NOT_OK) { ReturnValue = E_NOT_OK; }
@@ -182,8 +486,12 @@ StdReturnType TimerTwo::disablePwm(PwmPinType PwmPin)
     if(PWM_PIN_3 == PwmPin) {
         returnValue = E_OK;
         /* deactivate compare output mode in timer control register */
-        writeBit(TCCR2A, COM2B1, 0u);
+        Reg::Com2b::write<0u>();
     } 
+    if((PWM_PIN_11 == PwmPin) && WaveformPolicy::PWM_A_SUPPORTED) {
+        returnValue = E_OK;
+        Reg::Com2a::write<0u>();
+    }
 
     return returnValue;
 } /* disablePwm */
@@ -209,14 +517,17 @@ StdReturnType TimerTwo::setPwmDuty(PwmPinType PwmPin, byte DutyCycle)
         /* duty cycle out of bound? */
         if(DutyCycle <= TIMERTWO_RESOLUTION) {
             // use rule of three to calculate duty cycle related to timer top value 
-            // OCR2A is top value of timer
-            uint32_t DutyCycleTrans = OCR2A * DutyCycle;
-            DutyCycleTrans >>= TIMERTWO_NUMBER_OF_BITS;
+            // OCR2A is top value of timer or TOP is fixed, the mapping depends on the waveform mode
+            byte DutyCycleTrans = WaveformPolicy::duty(WaveformPolicy::FIXED_TOP ? TimerTwoPeriodSolver::TOP_MAX : OCR2A, DutyCycle);
             /* set output compare register value for given Pwm pin */
-            if(PWM_PIN_3 == PwmPin) {
+            if((PWM_PIN_3 == PwmPin) && WaveformPolicy::PWM_B_SUPPORTED) {
                 ReturnValue = E_OK;
                 OCR2B = DutyCycleTrans;
             }
+            if((PWM_PIN_11 == PwmPin) && WaveformPolicy::PWM_A_SUPPORTED) {
+                ReturnValue = E_OK;
+                OCR2A = DutyCycleTrans;
+            }
         }
     }
     return ReturnValue;
@@ -236,17 +547,31 @@ StdReturnType TimerTwo::setPwmDuty(PwmPinType PwmPin, byte DutyCycle)
 StdReturnType TimerTwo::start()
 {
     if((STATE_IDLE == State) || (STATE_STOPPED == State)) {
-        /* reset counter value */
+        uint8_t SregSave = SREG;
+        cli();
+        /* keep the clock monotonic, the elapsed part of the current period would get lost by resetting the counter.
+           Without a flag for the counting direction the position is unknown, the clock is not readable there anyway */
+        if(isCounterPositionAvailable()) {
+            uint32_t TicksHigh;
+            ClockTicksLow = getClockTicks(TicksHigh);
+            ClockTicksHigh = TicksHigh;
+        }
+        /* the tick interrupt is still enabled after stop(), the first timer clock would trigger it as a phantom tick */
+        TimerTwoField<Reg::Timsk2, WaveformPolicy::TICK_INTERRUPT>::write<0u>();
+        /* reset counter value, a pending overflow is already part of the clock */
         TCNT2 = 0u;
+        Reg::Tifr2::write<Reg::Tov2::Value<1u>, Reg::Ocf2a::Value<1u> >();
+        /* the first period already runs with the TOP and the duty cycles written since init() or stop() */
+        latchCompareRegisters();
+        SREG = SregSave;
         /* start counter by setting clock select register */
-        writeBitGroup(TCCR2B, TIMERTWO_REG_CS_GM, TIMERTWO_REG_CS_GP, ClockSelectBitGroup);
-        /* set overflow interrupt, if callback is set */
-        if(TimerIsrOverflowCallback != nullptr) {
-            /* wait until timer moved on from zero, otherwise get phantom interrupt */
-            while (TCNT2 == 0u);
-            /* enable timer overflow interrupt */
-            writeBit(TIMSK2, TOIE2, 1u);
-        }
+        Reg::Cs2::write(ClockSelectBitGroup);
+        /* wait until timer moved on from zero, otherwise get phantom interrupt */
+        while (TCNT2 == 0u);
+        /* clear stale flags, read() uses them to find out the counting direction */
+        Reg::Tifr2::write<Reg::Tov2::Value<1u>, Reg::Ocf2a::Value<1u> >();
+        /* tick interrupt is always enabled while running, it keeps the flags for read() up to date */
+        TimerTwoField<Reg::Timsk2, WaveformPolicy::TICK_INTERRUPT>::write<1u>();
         State = STATE_RUNNING;
         return E_OK;
     }
@@ -265,7 +590,7 @@ StdReturnType TimerTwo::start()
 void TimerTwo::stop()
 {
     /* stop counter by clearing clock select register */
-    writeBitGroup(TCCR2B, TIMERTWO_REG_CS_GM, TIMERTWO_REG_CS_GP, REG_CS_NO_CLOCK);
+    Reg::Cs2::write<REG_CS_NO_CLOCK>();
     State = STATE_STOPPED;
 } /* stop */
 
@@ -283,8 +608,14 @@ void TimerTwo::stop()
 StdReturnType TimerTwo::resume()
 {
     if(STATE_STOPPED == State) {
+        uint8_t SregSave = SREG;
+        cli();
+        /* compare values written while stopped are active from now on */
+        latchCompareRegisters();
         /* resume counter by setting clock select register */
-        writeBitGroup(TCCR2B, TIMERTWO_REG_CS_GM, TIMERTWO_REG_CS_GP, ClockSelectBitGroup);
+        Reg::Cs2::write(ClockSelectBitGroup);
+        State = STATE_RUNNING;
+        SREG = SregSave;
         return E_OK;
     }
     return E_NOT_OK;
@@ -304,15 +635,77 @@ StdReturnType TimerTwo::resume()
 StdReturnType TimerTwo::attachInterrupt(TimerIsrCallbackF_void TimerOverflowCallback)
 {
     if(TimerOverflowCallback != nullptr) {
+        /* the overflow interrupt may already be enabled, so update the pointer atomically */
+        uint8_t SregSave = SREG;
+        cli();
         TimerIsrOverflowCallback = TimerOverflowCallback;
-        /* enable timer overflow interrupt */
-        if(State == STATE_RUNNING) writeBit(TIMSK2, TOIE2, 1u);
+        TimerIsrContextCallback = nullptr;
+        TimerIsrElapsedCallback = nullptr;
+        SREG = SregSave;
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* attachInterrupt */
+
+
+/******************************************************************************************************************************************************
+  attachInterrupt()
+******************************************************************************************************************************************************/
+/*! \brief          set timer overflow interrupt callback with user context
+ *  \details        the callback is called with the given context, so one function can serve several objects without
+ *                  global state. attachInterrupt<Type, &Type::Method>(Object) binds a member function with this overload.
+ *                  A callback without context is replaced.
+ *
+ *  \param[in]      TimerOverflowCallback               timer overflow callback function
+ *  \param[in]      Context                             parameter of the callback function
+ *  \return         E_OK
+ *                  E_NOT_OK - Callback function is nullptr
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::attachInterrupt(TimerIsrCallbackF_pvoid TimerOverflowCallback, void* Context)
+{
+    if(TimerOverflowCallback != nullptr) {
+        uint8_t SregSave = SREG;
+        cli();
+        TimerIsrOverflowCallback = nullptr;
+        TimerIsrContextCallback = TimerOverflowCallback;
+        TimerIsrCallbackContext = Context;
+        TimerIsrElapsedCallback = nullptr;
+        SREG = SregSave;
         return E_OK;
     }
     return E_NOT_OK;
 } /* attachInterrupt */
 
 
+/******************************************************************************************************************************************************
+  attachElapsedInterrupt()
+******************************************************************************************************************************************************/
+/*! \brief          set timer overflow interrupt callback with the number of elapsed periods
+ *  \details        the callback gets the number of callback periods since its last call, normally 1. It is called with
+ *                  interrupts enabled, periods which elapse meanwhile are counted by the nested timer interrupt and
+ *                  passed to the next call instead of being lost. So software clocks and integrators stay correct if
+ *                  the callback sometimes takes longer than the period. Other callbacks are replaced.
+ *
+ *  \param[in]      TimerElapsedCallback                timer overflow callback function
+ *  \return         E_OK
+ *                  E_NOT_OK - Callback function is nullptr
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::attachElapsedInterrupt(TimerIsrCallbackF_uint16 TimerElapsedCallback)
+{
+    if(TimerElapsedCallback != nullptr) {
+        uint8_t SregSave = SREG;
+        cli();
+        TimerIsrOverflowCallback = nullptr;
+        TimerIsrContextCallback = nullptr;
+        TimerIsrElapsedCallback = TimerElapsedCallback;
+        ElapsedTicks = 0u;
+        SREG = SregSave;
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* attachElapsedInterrupt */
+
+
 /******************************************************************************************************************************************************
   detachInterrupt()
 ******************************************************************************************************************************************************/
@@ -323,41 +716,298 @@ StdReturnType TimerTwo::attachInterrupt(TimerIsrCallbackF_void TimerOverflowCall
  *****************************************************************************************************************************************************/
 void TimerTwo::detachInterrupt()
 {
-    /* clears the timer overflow interrupt enable bit */
-    writeBit(TIMSK2, TOIE2, 0u);
+    /* overflow interrupt stays enabled for read(), only the callback is removed */
+    uint8_t SregSave = SREG;
+    cli();
+    TimerIsrOverflowCallback = nullptr;
+    TimerIsrContextCallback = nullptr;
+    TimerIsrElapsedCallback = nullptr;
+    SREG = SregSave;
 } /* detachInterrupt */
 
 
+/******************************************************************************************************************************************************
+  dispatch()
+******************************************************************************************************************************************************/
+/*! \brief          call the deferred work items
+ *  \details        drains the work items which were queued by defer() in interrupt context. Call it from loop(), the
+ *                  items are called with interrupts enabled in the order they were queued. Items which are queued while
+ *                  dispatch() runs are called by the next dispatch(), so the runtime is bounded by the queue size.
+ *                  There must be only one consumer, do not call it from interrupt context.
+ *
+ *  \return         number of called work items
+ *****************************************************************************************************************************************************/
+byte TimerTwo::dispatch()
+{
+    byte Tail = DeferredTail;
+    byte Head = DeferredHead;
+    byte Count = Head - Tail;
+
+    TIMERTWO_MEMORY_BARRIER();
+    while(Tail != Head) {
+        /* copy the item before its slot is released to the producer */
+        DeferredItemType Item = DeferredQueue[Tail & (TIMERTWO_DEFERRED_QUEUE_SIZE - 1u)];
+        TIMERTWO_MEMORY_BARRIER();
+        DeferredTail = ++Tail;
+        Item.Function(Item.Context);
+    }
+    return Count;
+} /* dispatch */
+
+
+/******************************************************************************************************************************************************
+  getDeferredQueueStatistics()
+******************************************************************************************************************************************************/
+/*! \brief          get statistics of the deferred queue
+ *  \details        Overflows is the number of items defer() rejected because the queue was full, HighWaterMark the
+ *                  maximum number of queued items. Both are kept until resetDeferredQueueStatistics().
+ *
+ *  \return         statistics of the deferred queue
+ *****************************************************************************************************************************************************/
+TimerTwo::DeferredQueueStatisticsType TimerTwo::getDeferredQueueStatistics()
+{
+    DeferredQueueStatisticsType Statistics;
+    uint8_t SregSave = SREG;
+    cli();
+    Statistics.Overflows = DeferredStatistics.Overflows;
+    Statistics.HighWaterMark = DeferredStatistics.HighWaterMark;
+    SREG = SregSave;
+    return Statistics;
+} /* getDeferredQueueStatistics */
+
+
+/******************************************************************************************************************************************************
+  resetDeferredQueueStatistics()
+******************************************************************************************************************************************************/
+void TimerTwo::resetDeferredQueueStatistics()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    DeferredStatistics.Overflows = 0u;
+    DeferredStatistics.HighWaterMark = getDeferredCount();
+    SREG = SregSave;
+} /* resetDeferredQueueStatistics */
+
+
+/******************************************************************************************************************************************************
+  getOverrunStatistics()
+******************************************************************************************************************************************************/
+/*! \brief          get overrun statistics of the timer tick
+ *  \details        Overruns counts the timer interrupts which ended with the next tick already pending, so the callback
+ *                  or disabled interrupts took the time of a whole period. If this happens twice in a row, ticks are lost
+ *                  and the clock of readTicks() falls behind. MissedTicks counts the callback periods an elapsed callback
+ *                  (attachElapsedInterrupt()) was called late for. Both are kept until resetOverrunStatistics().
+ *
+ *  \return         overrun statistics
+ *****************************************************************************************************************************************************/
+TimerTwo::OverrunStatisticsType TimerTwo::getOverrunStatistics()
+{
+    OverrunStatisticsType Statistics;
+    uint8_t SregSave = SREG;
+    cli();
+    Statistics.Overruns = OverrunStatistics.Overruns;
+    Statistics.MissedTicks = OverrunStatistics.MissedTicks;
+    SREG = SregSave;
+    return Statistics;
+} /* getOverrunStatistics */
+
+
+/******************************************************************************************************************************************************
+  resetOverrunStatistics()
+******************************************************************************************************************************************************/
+void TimerTwo::resetOverrunStatistics()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    OverrunStatistics.Overruns = 0u;
+    OverrunStatistics.MissedTicks = 0u;
+    SREG = SregSave;
+} /* resetOverrunStatistics */
+
+
+#if TIMERTWO_STATISTICS
+/******************************************************************************************************************************************************
+  getStats()
+******************************************************************************************************************************************************/
+/*! \brief          get latency and callback duration statistics of the timer tick
+ *  \details        all values are timer counts (one count is prescaler CPU cycles). The latency is the counter position
+ *                  at the entry of the interrupt service routine, so it includes the interrupt response, the prologue
+ *                  and the time interrupts were disabled. It is only correct if it is shorter than TOP counts. The
+ *                  callback duration is measured from the entry to the return of the callback. Only available with
+ *                  TIMERTWO_STATISTICS enabled.
+ *
+ *  \param[out]     CurrentStatistics   copy of the statistics
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwo::getStats(Stats& CurrentStatistics)
+{
+    uint8_t SregSave = SREG;
+    cli();
+    CurrentStatistics = Statistics;
+    SREG = SregSave;
+} /* getStats */
+
+
+/******************************************************************************************************************************************************
+  resetStats()
+******************************************************************************************************************************************************/
+void TimerTwo::resetStats()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Statistics.Ticks = 0u;
+    Statistics.Callbacks = 0u;
+    Statistics.LatencyMin = UINT16_MAX;
+    Statistics.LatencyMax = 0u;
+    Statistics.CallbackMin = UINT16_MAX;
+    Statistics.CallbackMax = 0u;
+    for(byte Bin = 0u; Bin < TIMERTWO_STATISTICS_BINS; Bin++) {
+        Statistics.LatencyHistogram[Bin] = 0u;
+        Statistics.CallbackHistogram[Bin] = 0u;
+    }
+    SREG = SregSave;
+} /* resetStats */
+#endif
+
+
 /******************************************************************************************************************************************************
   read()
 ******************************************************************************************************************************************************/
 /*! \brief          read current timer value in microseconds
- *  \details        this function returns the current timer value in microseconds
+ *  \details        this function returns the time since the last callback period in microseconds. It does not wait for a counter tick,
+ *                  the counting direction is taken from the compare match flag of TOP, which is cleared at every BOTTOM
+ *                  by the overflow interrupt. So the runtime is constant and independent of the prescaler and the
+ *                  function can be called from main context and from interrupts. In the phase correct fixed TOP mode
+ *                  there is no flag for TOP, so the position is unknown and E_NOT_OK is returned.
  *                  
  *  \param[out]     Microseconds        current timer value
  *  \return         E_OK
- *                  E_NOT_OK - TimerTwo is not in running state
+ *                  E_NOT_OK - TimerTwo is not in running state or the waveform mode is TIMERTWO_MODE_PHASE_CORRECT_8BIT
  *  \pre            Timer has to be in RUNNING STATE
  *****************************************************************************************************************************************************/
 StdReturnType TimerTwo::read(TimeType& Microseconds)
 {
-    if(STATE_RUNNING == State) {
-        /* save current timer value */
-        uint16_t counterValue{TCNT2};
-		byte TCNT2_tmp{TCNT2};
-		
-        /* wait one counter tick, needed to find out counter counting up or down */
-        do { TCNT2_tmp = TCNT2; } while (counterValue == TCNT2_tmp);
-        /* if counter counting down, add top value to current value */
-        if(TCNT2_tmp < counterValue) { counterValue = (OCR2A - counterValue) + OCR2A; }
+    if(isCounterPositionAvailable() && (STATE_RUNNING == State)) {
+        uint8_t SregSave = SREG;
+        cli();
+        bool OverflowPending;
+        uint16_t CounterValue = getCounterPosition(OverflowPending);
+        /* hardware periods which elapsed since the last callback */
+        uint16_t ElapsedPeriods = Postscaler - PostscalerCount;
+        uint32_t Cycles = PeriodCycles;
+        SREG = SregSave;
+        if(OverflowPending) {
+            ElapsedPeriods++;
+            if(ElapsedPeriods >= Postscaler) { ElapsedPeriods = 0u; }
+        }
         /* transform counter value to microseconds in an efficient way */
-        Microseconds = ((counterValue * 1000uL) / (F_CPU / 1000uL)) << getPrescaleShiftScale();
+        Microseconds = countsToMicroseconds(CounterValue);
+        if(ElapsedPeriods != 0u) { Microseconds += (static_cast<uint64_t>(Cycles) * ElapsedPeriods) / (F_CPU / 1000000uL); }
         return E_OK;
     }
     return E_NOT_OK;
 } /* read */
 
 
+/******************************************************************************************************************************************************
+  readTicks()
+******************************************************************************************************************************************************/
+/*! \brief          read monotonic clock in CPU cycles
+ *  \details        this function returns the CPU cycles since the first start of the timer. The overflow count kept in
+ *                  the interrupt is extended by the current counter position, a pending overflow is taken into account.
+ *                  The resolution is the prescaler of the timer, e. g. 0.5 us at prescaler 8 and 16 MHz.
+ *                  The 32 bit value wraps around after 2^32 cycles (about 268 s at 16 MHz). Not available in the phase
+ *                  correct fixed TOP mode, the counter position is unknown there like in read().
+ *
+ *  \param[out]     Ticks               CPU cycles since first start
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not in running or stopped state or the waveform mode is TIMERTWO_MODE_PHASE_CORRECT_8BIT
+ *  \pre            Timer has to be in RUNNING or STOPPED STATE
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::readTicks(uint32_t& Ticks)
+{
+    if(isCounterPositionAvailable() && ((STATE_RUNNING == State) || (STATE_STOPPED == State))) {
+        uint32_t TicksHigh;
+        Ticks = getClockTicks(TicksHigh);
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* readTicks */
+
+
+/******************************************************************************************************************************************************
+  readTicks()
+******************************************************************************************************************************************************/
+/*! \brief          read monotonic clock in CPU cycles
+ *  \details        64 bit variant of readTicks(), does not wrap around
+ *
+ *  \param[out]     Ticks               CPU cycles since first start
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not in running or stopped state or the waveform mode is TIMERTWO_MODE_PHASE_CORRECT_8BIT
+ *  \pre            Timer has to be in RUNNING or STOPPED STATE
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::readTicks(uint64_t& Ticks)
+{
+    if(isCounterPositionAvailable() && ((STATE_RUNNING == State) || (STATE_STOPPED == State))) {
+        uint32_t TicksHigh;
+        uint32_t TicksLow = getClockTicks(TicksHigh);
+        Ticks = (static_cast<uint64_t>(TicksHigh) << 32u) | TicksLow;
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* readTicks */
+
+
+/******************************************************************************************************************************************************
+  readMicros()
+******************************************************************************************************************************************************/
+/*! \brief          read monotonic clock in microseconds
+ *  \details        the 32 bit value is taken from the 64 bit clock, so it wraps around after 2^32 microseconds like micros()
+ *
+ *  \param[out]     Microseconds        microseconds since first start
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not in running or stopped state
+ *  \pre            Timer has to be in RUNNING or STOPPED STATE
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::readMicros(uint32_t& Microseconds)
+{
+    uint64_t Micros;
+
+    if(readMicros(Micros) == E_OK) {
+        Microseconds = static_cast<uint32_t>(Micros);
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* readMicros */
+
+
+/******************************************************************************************************************************************************
+  readMicros()
+******************************************************************************************************************************************************/
+/*! \brief          read monotonic clock in microseconds
+ *  \details        
+ *
+ *  \param[out]     Microseconds        microseconds since first start
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is not in running or stopped state
+ *  \pre            Timer has to be in RUNNING or STOPPED STATE
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::readMicros(uint64_t& Microseconds)
+{
+    uint64_t Ticks;
+
+    if(readTicks(Ticks) == E_OK) {
+#if (F_CPU % 1000000uL) == 0uL
+        Microseconds = Ticks / (F_CPU / 1000000uL);
+#else
+        Microseconds = (Ticks * 1000u) / (F_CPU / 1000uL);
+#endif
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* readMicros */
+
+
 /******************************************************************************************************************************************************
  * P R I V A T E   F U N C T I O N S
 ******************************************************************************************************************************************************/
@@ -396,30 +1046,369 @@ inline byte TimerTwo::getPrescaleShiftScale()
 }
 
 /******************************************************************************************************************************************************
-  getPrescaleShiftScale()
+  getCounterPosition()
 ******************************************************************************************************************************************************/
-inline byte TimerTwo::getTimerCycles(TimeType Microseconds)
+/*! \brief          get timer counts since last BOTTOM
+ *  \details        In phase correct mode the counter counts up to TOP and down again. The overflow flag is set at BOTTOM
+ *                  and the compare match A flag at TOP, the flags are sampled before and after the counter, so a flag
+ *                  which changes while reading is detected and the result is exact. OverflowPending is set, if BOTTOM
+ *                  was passed but the tick interrupt was not executed yet.
+ *                  In CTC and fast PWM mode the counter only counts up, so just the tick flag is evaluated.
+ *                  Not used in the phase correct fixed TOP mode, see isCounterPositionAvailable().
+ *                  Interrupts have to be disabled by the caller.
+ *****************************************************************************************************************************************************/
+inline uint16_t TimerTwo::getCounterPosition(bool& OverflowPending)
 {
-    /* calculate timer cycles to reach timer period, counter runs backwards after TOP, interrupt is at BOTTOM so divide microseconds by 2 */
-    uint32_t TimerCycles = (F_CPU / 2000000uL) * Microseconds;
-    /* calculate timer pre-scaler */
-    if(TimerCycles < TIMERTWO_RESOLUTION)               ClockSelectBitGroup = REG_CS_NO_PRESCALER;
-    else if((TimerCycles >>= 3u) < TIMERTWO_RESOLUTION) ClockSelectBitGroup = REG_CS_PRESCALE_8;
-    else if((TimerCycles >>= 2u) < TIMERTWO_RESOLUTION) ClockSelectBitGroup = REG_CS_PRESCALE_32;
-    else if((TimerCycles >>= 1u) < TIMERTWO_RESOLUTION) ClockSelectBitGroup = REG_CS_PRESCALE_64;
-    else if((TimerCycles >>= 1u) < TIMERTWO_RESOLUTION) ClockSelectBitGroup = REG_CS_PRESCALE_128;
-    else if((TimerCycles >>= 1u) < TIMERTWO_RESOLUTION) ClockSelectBitGroup = REG_CS_PRESCALE_256;
-    else if((TimerCycles >>= 2u) < TIMERTWO_RESOLUTION) ClockSelectBitGroup = REG_CS_PRESCALE_1024;
+    byte FlagsBefore = TIFR2;
+    byte CounterValue = TCNT2;
+    byte FlagsAfter = TIFR2;
+
+    OverflowPending = (FlagsAfter & _BV(WaveformPolicy::TICK_FLAG)) != 0u;
+    /* BOTTOM passed but tick interrupt not yet executed, counter is counting up again */
+    if(FlagsBefore & _BV(WaveformPolicy::TICK_FLAG)) { return CounterValue; }
+    /* BOTTOM passed while reading, the counter value may be read before or after BOTTOM */
+    if(OverflowPending) { return 0u; }
+    /* single slope modes are counting up only */
+    if(!WaveformPolicy::DUAL_SLOPE) { return CounterValue; }
 
-    return TimerCycles;
+    byte Top = getActiveTop();
+    /* counter is counting down */
+    if(FlagsBefore & _BV(OCF2A)) { return (Top - CounterValue) + Top; }
+    /* TOP passed while reading */
+    if(FlagsAfter & _BV(OCF2A)) { return Top; }
+    /* counter is counting up */
+    return CounterValue;
 }
 
+/******************************************************************************************************************************************************
+  latchCompareRegisters()
+******************************************************************************************************************************************************/
+/*! \brief          copy OCR2A and OCR2B of the stopped timer from their buffers to the compare units
+ *  \details        in the PWM modes the compare registers are double buffered and latched at TOP or BOTTOM, which the
+ *                  stopped counter does not reach. In normal mode they are not buffered, so the values are written once
+ *                  more in normal mode and the waveform mode is restored afterwards. The counter is stopped, so there is
+ *                  no compare match meanwhile. A TOP below the position of the stopped counter is left to the hardware,
+ *                  the counter would pass it and run up to MAX.
+ *
+ *  \return         -
+ *  \pre            clock is stopped, interrupts are disabled
+ *****************************************************************************************************************************************************/
+void TimerTwo::latchCompareRegisters()
+{
+    if(WaveformPolicy::OCR_BUFFERED && (WaveformPolicy::FIXED_TOP || (TCNT2 <= OCR2A))) {
+        /* reading returns the buffer, which holds the last written value */
+        byte OcrA = OCR2A;
+        byte OcrB = OCR2B;
+        Reg::Tccr2a::modify<Reg::Wgm2a::Value<0u> >();
+        Reg::Tccr2b::modify<Reg::Wgm2b::Value<0u> >();
+        OCR2A = OcrA;
+        OCR2B = OcrB;
+        Reg::Tccr2a::modify<Reg::Wgm2a::Value<(WaveformPolicy::WGM & Reg::Wgm2a::MAX)> >();
+        Reg::Tccr2b::modify<Reg::Wgm2b::Value<(WaveformPolicy::WGM >> 2u)> >();
+    }
+} /* latchCompareRegisters */
+
+
+/******************************************************************************************************************************************************
+  countsToMicroseconds()
+******************************************************************************************************************************************************/
+inline TimerTwo::TimeType TimerTwo::countsToMicroseconds(uint16_t Counts)
+{
+#if (F_CPU % 1000000uL) == 0uL
+    /* with a whole number of cycles per microsecond the division becomes a shift for the common clock frequencies */
+    return (static_cast<uint32_t>(Counts) << getPrescaleShiftScale()) / (F_CPU / 1000000uL);
+#else
+    return ((Counts * 1000uL) / (F_CPU / 1000uL)) << getPrescaleShiftScale();
+#endif
+}
+
+/******************************************************************************************************************************************************
+  getClockTicks()
+******************************************************************************************************************************************************/
+/*! \brief          get monotonic clock in CPU cycles
+ *  \details        like micros() in wiring.c a pending overflow is added, so the clock never runs backwards
+ *****************************************************************************************************************************************************/
+inline uint32_t TimerTwo::getClockTicks(uint32_t& TicksHigh)
+{
+    bool OverflowPending;
+    uint8_t SregSave = SREG;
+    cli();
+    uint16_t CounterValue = getCounterPosition(OverflowPending);
+    uint32_t TicksLow = ClockTicksLow;
+    uint32_t Period = getActivePeriodCycles();
+    TicksHigh = ClockTicksHigh;
+    SREG = SregSave;
+
+    if(OverflowPending) {
+        TicksLow += Period;
+        if(TicksLow < Period) { TicksHigh++; }
+    }
+    uint32_t Offset = static_cast<uint32_t>(CounterValue) << getPrescaleShiftScale();
+    TicksLow += Offset;
+    if(TicksLow < Offset) { TicksHigh++; }
+    return TicksLow;
+}
+
+/******************************************************************************************************************************************************
+  applyPeriod()
+******************************************************************************************************************************************************/
+/*! \brief          write TOP and prescaler of a new period and reset the period state
+ *  \details        shared by setPeriod() and the compile time init<>() and setPeriod<>(), so they leave the clock, the
+ *                  postscaler and the dither state alike. No staged update may be pending.
+ *****************************************************************************************************************************************************/
+void TimerTwo::applyPeriod(byte Top, ClockSelectType NewClockSelect, uint16_t NewPostscaler, TimeType Microseconds, const DitherStateType& NewDitherState)
+{
+    ClockSelectBitGroup = NewClockSelect;
+    /* OCR2A is TOP, except in the fixed TOP modes where it is the duty cycle of pin 11 */
+    if(!WaveformPolicy::FIXED_TOP) { OCR2A = Top; }
+    PeriodMicroseconds = Microseconds;
+    /* one period takes (TOP + TOP_OFFSET) << COUNT_SHIFT timer counts, the clock is advanced by this in the overflow interrupt */
+    uint8_t SregSave = SREG;
+    cli();
+    DitherStepCycles = (1uL << WaveformPolicy::COUNT_SHIFT) << getPrescaleShiftScale();
+    PeriodCycles = (Top + WaveformPolicy::TOP_OFFSET) * DitherStepCycles;
+    Postscaler = NewPostscaler;
+    PostscalerCount = NewPostscaler;
+    DitherState = NewDitherState;
+    DitherState.Accumulator = 0u;
+    DitherLongActive = false;
+    DitherLongPending = false;
+    SREG = SregSave;
+
+    if(isClockRunning()) {
+        /* reset clock select register, and start the clock */
+        Reg::Cs2::write(ClockSelectBitGroup);
+    }
+}
+
+/******************************************************************************************************************************************************
+  getTimerCycles()
+******************************************************************************************************************************************************/
+/*! \brief          calculate prescaler, TOP value and postscaler for given period
+ *  \details        for periods up to getPeriodMax() every prescaler is evaluated, the one with the minimum period error is
+ *                  taken (see TimerTwoPeriodSolver).
+ *                  Periods greater than getPeriodMax() are split into Postscaler hardware periods. For each prescaler the
+ *                  smallest postscaler which fits TOP into 8 bit is taken, so TOP is in the upper half, and TOP is rounded
+ *                  to the nearest step. This costs two divisions per prescaler and the error is at most half a postscaler
+ *                  in timer steps. The prescalers are evaluated beginning with the longest hardware period, the one with
+ *                  the minimum error of the whole period is taken, on equal error the longer hardware period wins, so the
+ *                  number of interrupts is as low as possible. The search stops at the first exact combination.
+ *****************************************************************************************************************************************************/
+inline byte TimerTwo::getTimerCycles(TimeType Microseconds, uint16_t& PostscalerBest, ClockSelectType& ClockSelectBest)
+{
+    byte TopBest = TimerTwoPeriodSolver::TOP_MIN;
+
+    PostscalerBest = 1u;
+    ClockSelectBest = ClockSelectBitGroup;
+    if(WaveformPolicy::FIXED_TOP) {
+        getFixedTopCycles(Microseconds, PostscalerBest, ClockSelectBest);
+        TopBest = TimerTwoPeriodSolver::TOP_MAX;
+    } else if(Microseconds <= getPeriodMax()) {
+        uint32_t Cycles = TimerTwoPeriodSolver::cycles(Microseconds);
+        byte Index = TimerTwoPeriodSolver::bestIndex(Cycles);
+        ClockSelectBest = static_cast<ClockSelectType>(Index + 1u);
+        TopBest = TimerTwoPeriodSolver::top(Cycles, Index);
+    } else {
+        const uint16_t StepsMax = TimerTwoPeriodSolver::TOP_MAX + TimerTwoPeriodSolver::TOP_OFFSET;
+        uint64_t Cycles = (static_cast<uint64_t>(Microseconds) * (F_CPU / 1000uL)) / 1000u;
+        uint32_t ErrorMin = UINT32_MAX;
+
+        for(byte Index = TimerTwoPeriodSolver::NUMBER_OF_PRESCALERS; (Index > 0u) && (ErrorMin != 0u); Index--) {
+            /* one hardware period takes Steps = TOP + TOP_OFFSET steps, so Cycles = Postscaler * Steps * Divider */
+            byte DividerShift = TimerTwoPeriodSolver::stepShift(Index - 1u);
+            uint64_t Counts = Cycles >> DividerShift;
+            int32_t Remainder = static_cast<int32_t>(Cycles & ((1uL << DividerShift) - 1u));
+
+            /* postscaler would be out of range for every TOP */
+            if(Counts > (static_cast<uint32_t>(TIMERTWO_POSTSCALER_MAX) * StepsMax)) { continue; }
+
+            /* smallest postscaler which fits TOP into 8 bit, TOP rounded to the nearest step */
+            uint32_t Postscaler = (static_cast<uint32_t>(Counts) + (StepsMax - 1u)) / StepsMax;
+            uint16_t Steps = (static_cast<uint32_t>(Counts) + (Postscaler >> 1u)) / Postscaler;
+            if(Steps < (TIMERTWO_POSTSCALER_TOP_MIN + TimerTwoPeriodSolver::TOP_OFFSET)) { continue; }
+
+            /* error of the whole period in CPU cycles */
+            int32_t Difference = static_cast<int32_t>((Postscaler * Steps) - static_cast<uint32_t>(Counts));
+            Difference = (Difference * (1L << DividerShift)) - Remainder;
+            uint32_t Error = (Difference < 0) ? static_cast<uint32_t>(-Difference) : static_cast<uint32_t>(Difference);
+
+            if(Error < ErrorMin) {
+                ErrorMin = Error;
+                TopBest = Steps - TimerTwoPeriodSolver::TOP_OFFSET;
+                PostscalerBest = Postscaler;
+                ClockSelectBest = static_cast<ClockSelectType>(Index);
+            }
+        }
+    }
+    return TopBest;
+}
+
+/******************************************************************************************************************************************************
+  getFixedTopCycles()
+******************************************************************************************************************************************************/
+/*! \brief          calculate prescaler and postscaler for the fixed TOP modes
+ *  \details        the hardware period is given by the prescaler only, the callback period is a multiple of it. All
+ *                  prescalers are evaluated beginning with the longest hardware period, the combination with the minimum
+ *                  error is taken. The number of interrupts is kept within TIMERTWO_FIXED_TOP_INTERRUPT_FACTOR times the
+ *                  minimum, so a short prescaler is not chosen only to reduce the error. With the tone generator only
+ *                  TIMERTWO_TONE_CLOCK_SELECT is evaluated, the hardware period is its sample period.
+ *****************************************************************************************************************************************************/
+inline void TimerTwo::getFixedTopCycles(TimeType Microseconds, uint16_t& PostscalerBest, ClockSelectType& ClockSelectBest)
+{
+    uint64_t Cycles = (static_cast<uint64_t>(Microseconds) * (F_CPU / 1000uL)) / 1000u;
+    uint64_t ErrorMin = UINT64_MAX;
+    const uint32_t HardwareCyclesMax = TimerTwoPeriodSolver::periodCycles(TimerTwoPeriodSolver::TOP_MAX, TimerTwoPeriodSolver::NUMBER_OF_PRESCALERS - 1u);
+    /* the tone generator needs its sample rate, so only its prescaler is evaluated and the postscaler is not limited */
+    const uint32_t PostscalerLimit = TIMERTWO_TONE_VOICES ? TIMERTWO_POSTSCALER_MAX : (TIMERTWO_FIXED_TOP_INTERRUPT_FACTOR * static_cast<uint32_t>((Cycles / HardwareCyclesMax) + 1u));
+    const byte IndexFirst = TIMERTWO_TONE_VOICES ? TIMERTWO_TONE_CLOCK_SELECT : TimerTwoPeriodSolver::NUMBER_OF_PRESCALERS;
+    const byte IndexLast = TIMERTWO_TONE_VOICES ? (TIMERTWO_TONE_CLOCK_SELECT - 1u) : 0u;
+
+    for(byte Index = IndexFirst; (Index > IndexLast) && (ErrorMin != 0u); Index--) {
+        uint32_t HardwareCycles = TimerTwoPeriodSolver::periodCycles(TimerTwoPeriodSolver::TOP_MAX, Index - 1u);
+        uint64_t Postscaler = (Cycles + (HardwareCycles >> 1u)) / HardwareCycles;
+        if(Postscaler == 0u) { Postscaler = 1u; }
+        if((Postscaler > PostscalerLimit) || (Postscaler > TIMERTWO_POSTSCALER_MAX)) { continue; }
+
+        uint64_t Period = Postscaler * HardwareCycles;
+        uint64_t Error = (Period > Cycles) ? (Period - Cycles) : (Cycles - Period);
+        if(Error < ErrorMin) {
+            ErrorMin = Error;
+            PostscalerBest = Postscaler;
+            ClockSelectBest = static_cast<ClockSelectType>(Index);
+        }
+    }
+}
+
+/******************************************************************************************************************************************************
+  getDitherCycles()
+******************************************************************************************************************************************************/
+/*! \brief          calculate prescaler, TOP fraction and postscaler for dithering
+ *  \details        the smallest prescaler with which TOP + 1 still fits into the counter is taken, so the jitter is as
+ *                  small as possible. Longer periods use prescaler 1024 and the postscaler. The exact hardware period is
+ *                  Top + Fraction / Denominator TOP steps.
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwo::getDitherCycles(TimeType Microseconds, uint16_t& NewPostscaler, DitherStateType& NewDitherState, ClockSelectType& NewClockSelect)
+{
+    uint64_t Cycles = (static_cast<uint64_t>(Microseconds) * (F_CPU / 1000uL)) / 1000u;
+    byte Index = 0u;
+    byte StepShift = TimerTwoPeriodSolver::stepShift(Index);
+    uint32_t Postscaler = 1u;
+    /* a period of TOP + 1 has to fit into the counter */
+    const uint16_t StepsMax = TimerTwoPeriodSolver::TOP_MAX + TimerTwoPeriodSolver::TOP_OFFSET - 1u;
+
+    /* one TOP step takes 2 * prescaler CPU cycles in phase correct mode and prescaler CPU cycles otherwise */
+    while((Cycles >> StepShift) > StepsMax) {
+        if(++Index >= TimerTwoPeriodSolver::NUMBER_OF_PRESCALERS) {
+            Index = TimerTwoPeriodSolver::NUMBER_OF_PRESCALERS - 1u;
+            Postscaler = static_cast<uint32_t>((Cycles >> StepShift) / StepsMax) + 1u;
+            break;
+        }
+        StepShift = TimerTwoPeriodSolver::stepShift(Index);
+    }
+    if((Postscaler > TIMERTWO_POSTSCALER_MAX) || (Cycles < ((TimerTwoPeriodSolver::TOP_MIN + TimerTwoPeriodSolver::TOP_OFFSET) * (1uL << StepShift)))) { return E_NOT_OK; }
+
+    NewPostscaler = Postscaler;
+    NewDitherState.Denominator = Postscaler << StepShift;
+    NewDitherState.Top = (Cycles / NewDitherState.Denominator) - TimerTwoPeriodSolver::TOP_OFFSET;
+    NewDitherState.Fraction = Cycles - ((static_cast<uint64_t>(NewDitherState.Top) + TimerTwoPeriodSolver::TOP_OFFSET) * NewDitherState.Denominator);
+    NewDitherState.Accumulator = 0u;
+    NewClockSelect = static_cast<ClockSelectType>(Index + 1u);
+    return E_OK;
+}
+
+/******************************************************************************************************************************************************
+  callTimerIsrElapsedCallback()
+******************************************************************************************************************************************************/
+/*! \brief          call the elapsed callback from the timer interrupt
+ *  \details        the callback runs with interrupts enabled. A timer interrupt which occurs meanwhile only counts the
+ *                  elapsed period, the next call gets all periods since the last call. It overwrites the entry count of
+ *                  the statistics, so the count of the outer interrupt is saved and restored.
+ *****************************************************************************************************************************************************/
+void TimerTwo::callTimerIsrElapsedCallback()
+{
+    uint16_t Elapsed = ElapsedTicks + 1u;
+
+    if(ElapsedCallbackActive) {
+        /* nested interrupt, the callback of the outer interrupt is still running */
+        ElapsedTicks = Elapsed;
+        return;
+    }
+    ElapsedTicks = 0u;
+    if(Elapsed > 1u) {
+        uint16_t Missed = OverrunStatistics.MissedTicks + (Elapsed - 1u);
+        OverrunStatistics.MissedTicks = (Missed < OverrunStatistics.MissedTicks) ? UINT16_MAX : Missed;
+    }
+#if TIMERTWO_STATISTICS
+    byte EntryCount = TickEntryCount;
+#endif
+    ElapsedCallbackActive = true;
+    sei();
+    TimerIsrElapsedCallback(Elapsed);
+    cli();
+    ElapsedCallbackActive = false;
+#if TIMERTWO_STATISTICS
+    TickEntryCount = EntryCount;
+#endif
+}
+
+
 /******************************************************************************************************************************************************
   I S R   F U N C T I O N S
 ******************************************************************************************************************************************************/
-ISR(TIMER2_OVF_vect)
+#if TIMERTWO_PROFILER && defined(__AVR__)
+/* The interrupted PC is on top of the stack only at the entry of the vector, so a naked stub stores it and jumps to
+ * the interrupt service routine, which returns to the interrupted code with reti. AVR pushes the PC big endian, after
+ * the three registers of the stub its high byte is at SP + 4 (SP + 5 with a 3 byte PC). */
+#if defined(__AVR_3_BYTE_PC__)
+# define TIMERTWO_PROFILER_PC_OFFSET                "5"
+#else
+# define TIMERTWO_PROFILER_PC_OFFSET                "4"
+#endif
+#if defined(__AVR_HAVE_JMP_CALL__)
+# define TIMERTWO_PROFILER_JMP                      "jmp "
+#else
+# define TIMERTWO_PROFILER_JMP                      "rjmp "
+#endif
+
+ISR(TIMERTWO_TICK_vect, ISR_NAKED __attribute__((weak)))
+{
+    asm volatile(
+        "push r0"                                           "\n\t"
+        "push r30"                                          "\n\t"
+        "push r31"                                          "\n\t"
+        "in r30, __SP_L__"                                  "\n\t"
+        "in r31, __SP_H__"                                  "\n\t"
+        "ldd r0, Z+" TIMERTWO_PROFILER_PC_OFFSET            "\n\t"
+        "sts TimerTwoProfilerPc+1, r0"                      "\n\t"
+        "ldd r0, Z+" TIMERTWO_PROFILER_PC_OFFSET "+1"       "\n\t"
+        "sts TimerTwoProfilerPc, r0"                        "\n\t"
+        "pop r31"                                           "\n\t"
+        "pop r30"                                           "\n\t"
+        "pop r0"                                            "\n\t"
+        TIMERTWO_PROFILER_JMP "__vector_timertwo_profiler"  "\n\t"
+    );
+}
+
+/* name starts with __vector, so avr-gcc accepts the signal attribute */
+ISR(__vector_timertwo_profiler)
+{
+    Timer2Profiler.sample(TimerTwoProfilerPc);
+#elif TIMERTWO_PROFILER
+/* the host model has no program counter, the application sets TimerTwoProfilerPc before it steps the model */
+ISR(TIMERTWO_TICK_vect, __attribute__((weak)))
 {
-    Timer2.callTimerIsrOverflowCallback();
+    Timer2Profiler.sample(TimerTwoProfilerPc);
+#else
+/* weak, so TIMERTWO_ISR() in the application replaces it */
+ISR(TIMERTWO_TICK_vect, __attribute__((weak)))
+{
+#endif
+    TIMERTWO_TONE_UPDATE();
+    if(Timer2.updateTick()) {
+        Timer2.callTimerIsrOverflowCallback();
+        Timer2.updateCallbackStatistics();
+    }
+    Timer2.checkOverrun();
 }
 
 
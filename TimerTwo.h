@@ -21,10 +21,10 @@
 /******************************************************************************************************************************************************
  * INCLUDES
  *****************************************************************************************************************************************************/
-#include "Arduino.h"
-#include <avr/io.h>
-#include <avr/interrupt.h>
+#include "TimerTwoHal.h"
+#include "TimerTwoRegister.h"
 #include <StandardTypes.h>
+#include "TimerTwo_Cfg.h"
 
 
 /******************************************************************************************************************************************************
@@ -41,11 +41,31 @@
 #define TIMERTWO_B_ARDUINO_PIN                      3u
 //#define TIMERTWO_A_PORT_PIN                       PORTD3
 
-#define TIMERTWO_REG_CS_GP                          0u
-#define TIMERTWO_REG_CS_GM                          B111
-
 #define TIMERTWO_MAX_PRESCALER                      1024u
 
+/* software postscaler for periods greater than getPeriodMax() */
+#define TIMERTWO_POSTSCALER_MAX                     0xFFFFu
+/* smallest TOP value which is evaluated for postscaled periods, keeps the number of interrupts within twice the minimum */
+#define TIMERTWO_POSTSCALER_TOP_MIN                 (TIMERTWO_RESOLUTION / 2u)
+/* in the fixed TOP modes the number of interrupts per period is kept within this factor of the minimum, so at least one shorter prescaler is evaluated */
+#define TIMERTWO_FIXED_TOP_INTERRUPT_FACTOR         8u
+
+/* parts of a staged update */
+#define TIMERTWO_UPDATE_PERIOD                      0x01u
+#define TIMERTWO_UPDATE_DUTY_A                      0x02u
+#define TIMERTWO_UPDATE_DUTY_B                      0x04u
+
+#if ((TIMERTWO_DEFERRED_QUEUE_SIZE & (TIMERTWO_DEFERRED_QUEUE_SIZE - 1u)) != 0u) || (TIMERTWO_DEFERRED_QUEUE_SIZE > 128u) || (TIMERTWO_DEFERRED_QUEUE_SIZE == 0u)
+# error "TimerTwo: TIMERTWO_DEFERRED_QUEUE_SIZE has to be a power of two between 1 and 128"
+#endif
+
+/* interrupt vector of the timer tick, in CTC mode the counter is cleared at compare match A and never overflows */
+#if (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_CTC)
+# define TIMERTWO_TICK_vect                         TIMER2_COMPA_vect
+#else
+# define TIMERTWO_TICK_vect                         TIMER2_OVF_vect
+#endif
+
 #if __cplusplus < 201103L
 # define nullptr NULL
 #endif
@@ -53,11 +73,182 @@
 /******************************************************************************************************************************************************
  *  LOCAL FUNCTION MACROS
  *****************************************************************************************************************************************************/
+/* keeps the compiler from moving memory accesses across the index update of the deferred queue */
+#define TIMERTWO_MEMORY_BARRIER()                   asm volatile("" ::: "memory")
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL FUNCTION MACROS
+ *****************************************************************************************************************************************************/
+/* one sample of the tone generator in every hardware period, before the postscaler (TimerTwoTone.h) */
+#if TIMERTWO_TONE_VOICES
+# define TIMERTWO_TONE_UPDATE()                     Timer2Tone.updateSample()
+#else
+# define TIMERTWO_TONE_UPDATE()
+#endif
+
+/* Defines the Timer2 interrupt service routine with a callback bound at compile time. The callback is called directly
+ * instead of through the function pointer of attachInterrupt(), so it can be inlined into the vector and the compiler
+ * only saves the registers which are really used. Use it once in one source file, it replaces the interrupt service
+ * routine of the library and callbacks attached with attachInterrupt() are not called anymore. */
+#define TIMERTWO_ISR(Callback)                      ISR(TIMERTWO_TICK_vect) { TIMERTWO_TONE_UPDATE(); if(Timer2.updateTick()) { Callback(); Timer2.updateCallbackStatistics(); } Timer2.checkOverrun(); }
+
+/* Defines a minimal Timer2 interrupt service routine for initStopwatch(), which only extends the cycle counter by 256.
+ * The tick interrupt of the library (clock, postscaler, callbacks, about 100 cycles) would be included in every
+ * measurement, this one takes about 60 cycles per 256 cycles. Use it once in one source file instead of TIMERTWO_ISR(),
+ * the callbacks, the clock (readTicks(), readMicros()) and the tone generator are not updated anymore. */
+#define TIMERTWO_STOPWATCH_ISR()                    ISR(TIMERTWO_TICK_vect) { Timer2.updateStopwatch(); }
+
+/* Measures the rest of the enclosing block and adds it to the TimerTwo::Stopwatch::Section */
+#define TIMERTWO_STOPWATCH_SCOPE(Section)           TIMERTWO_STOPWATCH_SCOPE_NAME(Section, __LINE__)
+#define TIMERTWO_STOPWATCH_SCOPE_NAME(Section, Line) TIMERTWO_STOPWATCH_SCOPE_LINE(Section, Line)
+#define TIMERTWO_STOPWATCH_SCOPE_LINE(Section, Line) TimerTwo::Stopwatch::Scope TimerTwoStopwatchScope##Line(Section)
 
 
 /******************************************************************************************************************************************************
  *  GLOBAL DATA TYPES AND STRUCTURES
  *****************************************************************************************************************************************************/
+/*! \brief          waveform generation mode policies
+ *  \details        each policy describes one mode with TOP = OCR2A. One period takes (TOP + TOP_OFFSET) << COUNT_SHIFT timer
+ *                  counts. All members are compile time constants, so the branches of the other modes compile away.
+ *                  TICK_FLAG and TICK_INTERRUPT are the flag and the interrupt enable bit of the timer tick at BOTTOM,
+ *                  OCR_BUFFERED is true if OCR2A is double buffered, so a new TOP is active one period later.
+ *                  In the fixed TOP modes TOP is 0xFF and OCR2A is free for the PWM of pin 11, the period is only given by
+ *                  the prescaler. TOP_MATCH_FLAG is true if the compare match A flag marks TOP.
+ *****************************************************************************************************************************************************/
+struct TimerTwoCtcPolicy
+{
+    static constexpr byte WGM = TIMERTWO_MODE_CTC;
+    static constexpr bool DUAL_SLOPE = false;
+    static constexpr bool FIXED_TOP = false;
+    static constexpr bool TOP_MATCH_FLAG = true;
+    static constexpr byte COUNT_SHIFT = 0u;
+    static constexpr byte TOP_OFFSET = 1u;
+    static constexpr bool OCR_BUFFERED = false;
+    static constexpr bool PWM_A_SUPPORTED = false;
+    static constexpr bool PWM_B_SUPPORTED = false;
+    static constexpr byte TICK_FLAG = OCF2A;
+    static constexpr byte TICK_INTERRUPT = OCIE2A;
+    /* no PWM output in CTC mode */
+    static constexpr byte duty(byte, byte) { return 0u; }
+};
+
+struct TimerTwoPhaseCorrectPolicy
+{
+    static constexpr byte WGM = TIMERTWO_MODE_PHASE_CORRECT;
+    static constexpr bool DUAL_SLOPE = true;
+    static constexpr bool FIXED_TOP = false;
+    static constexpr bool TOP_MATCH_FLAG = true;
+    static constexpr byte COUNT_SHIFT = 1u;
+    static constexpr byte TOP_OFFSET = 0u;
+    static constexpr bool OCR_BUFFERED = true;
+    static constexpr bool PWM_A_SUPPORTED = false;
+    static constexpr bool PWM_B_SUPPORTED = true;
+    static constexpr byte TICK_FLAG = TOV2;
+    static constexpr byte TICK_INTERRUPT = TOIE2;
+    /* output is high while the counter is below OCR2B, so the duty cycle is OCR2B / TOP */
+    static constexpr byte duty(byte Top, byte DutyCycle) { return (static_cast<uint16_t>(Top) * DutyCycle) >> TIMERTWO_NUMBER_OF_BITS; }
+};
+
+struct TimerTwoFastPwmPolicy
+{
+    static constexpr byte WGM = TIMERTWO_MODE_FAST_PWM;
+    static constexpr bool DUAL_SLOPE = false;
+    static constexpr bool FIXED_TOP = false;
+    static constexpr bool TOP_MATCH_FLAG = false;
+    static constexpr byte COUNT_SHIFT = 0u;
+    static constexpr byte TOP_OFFSET = 1u;
+    static constexpr bool OCR_BUFFERED = true;
+    static constexpr bool PWM_A_SUPPORTED = false;
+    static constexpr bool PWM_B_SUPPORTED = true;
+    static constexpr byte TICK_FLAG = TOV2;
+    static constexpr byte TICK_INTERRUPT = TOIE2;
+    /* output is high from BOTTOM up to the compare match, so the duty cycle is (OCR2B + 1) / (TOP + 1) */
+    static constexpr byte duty(byte Top, byte DutyCycle) { return ((static_cast<uint16_t>(Top) + 1u) * DutyCycle) >> TIMERTWO_NUMBER_OF_BITS; }
+};
+
+/* the fixed TOP modes count like their OCR2A counterparts, the compare match A flag is the duty cycle of pin 11 */
+struct TimerTwoPhaseCorrect8BitPolicy : TimerTwoPhaseCorrectPolicy
+{
+    static constexpr byte WGM = TIMERTWO_MODE_PHASE_CORRECT_8BIT;
+    static constexpr bool FIXED_TOP = true;
+    static constexpr bool TOP_MATCH_FLAG = false;
+    static constexpr bool PWM_A_SUPPORTED = true;
+};
+
+struct TimerTwoFastPwm8BitPolicy : TimerTwoFastPwmPolicy
+{
+    static constexpr byte WGM = TIMERTWO_MODE_FAST_PWM_8BIT;
+    static constexpr bool FIXED_TOP = true;
+    static constexpr bool PWM_A_SUPPORTED = true;
+};
+
+/* normal mode counts like the fixed TOP fast PWM mode, but has no PWM and no double buffering */
+struct TimerTwoNormalPolicy : TimerTwoFastPwm8BitPolicy
+{
+    static constexpr byte WGM = TIMERTWO_MODE_NORMAL;
+    static constexpr bool OCR_BUFFERED = false;
+    static constexpr bool PWM_A_SUPPORTED = false;
+    static constexpr bool PWM_B_SUPPORTED = false;
+    static constexpr byte duty(byte, byte) { return 0u; }
+};
+
+#if (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_NORMAL)
+typedef TimerTwoNormalPolicy TimerTwoWaveformPolicy;
+#elif (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_CTC)
+typedef TimerTwoCtcPolicy TimerTwoWaveformPolicy;
+#elif (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_PHASE_CORRECT)
+typedef TimerTwoPhaseCorrectPolicy TimerTwoWaveformPolicy;
+#elif (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_FAST_PWM)
+typedef TimerTwoFastPwmPolicy TimerTwoWaveformPolicy;
+#elif (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_PHASE_CORRECT_8BIT)
+typedef TimerTwoPhaseCorrect8BitPolicy TimerTwoWaveformPolicy;
+#elif (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_FAST_PWM_8BIT)
+typedef TimerTwoFastPwm8BitPolicy TimerTwoWaveformPolicy;
+#else
+# error "TimerTwo: TIMERTWO_WAVEFORM_MODE has to be one of the TIMERTWO_MODE_ values of TimerTwo_Cfg.h"
+#endif
+
+
+/*! \brief          prescaler and TOP solver for the Timer2 period
+ *  \details        all functions are constexpr, so the same solver is used by setPeriod() at runtime and by TimerTwoConfig
+ *                  at compile time. Every prescaler is evaluated with the nearest TOP value and the one with the minimum
+ *                  period error is taken, on equal error the smaller prescaler wins because of the higher resolution.
+ *                  Prescaler index 0 is no prescaler, index 6 is prescaler 1024, so the Clock Select Bit Group is index + 1.
+ *****************************************************************************************************************************************************/
+struct TimerTwoPeriodSolver
+{
+    static constexpr byte NUMBER_OF_PRESCALERS = 7u;
+    static constexpr byte TOP_MIN = 1u;
+    static constexpr byte TOP_MAX = TIMERTWO_RESOLUTION - 1u;
+    /* one period takes (TOP + TOP_OFFSET) << COUNT_SHIFT timer counts */
+    static constexpr byte COUNT_SHIFT = TimerTwoWaveformPolicy::COUNT_SHIFT;
+    static constexpr byte TOP_OFFSET = TimerTwoWaveformPolicy::TOP_OFFSET;
+    static constexpr bool FIXED_TOP = TimerTwoWaveformPolicy::FIXED_TOP;
+
+    /* CPU cycles of the given period */
+    static constexpr uint32_t cycles(uint32_t Microseconds) { return (Microseconds * (F_CPU / 1000uL)) / 1000uL; }
+    /* prescaler as power of two: 1, 8, 32, 64, 128, 256, 1024 */
+    static constexpr byte prescaleShiftScale(byte Index) { return (Index < 2u) ? (3u * Index) : ((Index < 6u) ? (Index + 3u) : 10u); }
+    static constexpr uint32_t limitTop(uint32_t Top) { return (Top > TOP_MAX) ? TOP_MAX : ((Top < TOP_MIN) ? TOP_MIN : Top); }
+    /* CPU cycles of one TOP step */
+    static constexpr byte stepShift(byte Index) { return prescaleShiftScale(Index) + COUNT_SHIFT; }
+    static constexpr uint32_t steps(uint32_t Cycles, byte Index) { return (Cycles + ((1uL << stepShift(Index)) >> 1u)) >> stepShift(Index); }
+    /* round to the nearest TOP, in the fixed TOP modes only the prescaler can be chosen */
+    static constexpr byte top(uint32_t Cycles, byte Index) {
+        return FIXED_TOP ? TOP_MAX : limitTop((steps(Cycles, Index) > TOP_OFFSET) ? (steps(Cycles, Index) - TOP_OFFSET) : 0u);
+    }
+    static constexpr uint32_t periodCycles(byte Top, byte Index) { return (static_cast<uint32_t>(Top) + TOP_OFFSET) << stepShift(Index); }
+    static constexpr uint32_t difference(uint32_t A, uint32_t B) { return (A > B) ? (A - B) : (B - A); }
+    static constexpr uint32_t error(uint32_t Cycles, byte Index) { return difference(periodCycles(top(Cycles, Index), Index), Cycles); }
+    /* index of the prescaler with the minimum error */
+    static constexpr byte bestIndex(uint32_t Cycles, byte Index = 1u, byte Best = 0u) {
+        return (Index >= NUMBER_OF_PRESCALERS) ? Best : bestIndex(Cycles, Index + 1u, (error(Cycles, Index) < error(Cycles, Best)) ? Index : Best);
+    }
+    /* achieved period in nanoseconds, F_CPU has to be a multiple of 8 kHz */
+    static constexpr uint64_t nanoseconds(uint64_t Cycles) { return (Cycles * 125000uLL) / (F_CPU / 8000uL); }
+};
+
 
 
 /******************************************************************************************************************************************************
@@ -71,12 +262,17 @@ class TimerTwo
   public:
     /* Timer ISR callback function */
     typedef void (*TimerIsrCallbackF_void)(void);
+    /* Timer ISR callback function with user context */
+    typedef void (*TimerIsrCallbackF_pvoid)(void*);
+    /* Timer ISR callback function with the number of elapsed callback periods */
+    typedef void (*TimerIsrCallbackF_uint16)(uint16_t);
 
-#if F_CPU < 8000000uL
     using TimeType = uint32_t;
-#else
-    using TimeType = uint16_t;
-#endif
+
+    /* waveform generation mode selected by TIMERTWO_WAVEFORM_MODE */
+    typedef TimerTwoWaveformPolicy WaveformPolicy;
+    /* Timer2 registers and bit fields */
+    typedef TimerTwoRegisters Reg;
 
     /* Type which describes the internal state of the TimerTwo */
     enum StateType {
@@ -99,17 +295,124 @@ class TimerTwo
     };
     
     /*
-        Info: PWM for Pin 11 can not be used because in Mode 5 (PWM, Phase Correct) 
+        Info: PWM for Pin 11 can only be used in the fixed TOP modes (TOP = 0xFF). In all other modes
               OCRA is TOP value of the Timer/Counter. So Duty Cycle for OC2A Pin 11
               can not be set, otherwise counter top value will be overwritten.
     */
 
+    /* State of the TOP dithering, the exact TOP is Top + Fraction / Denominator */
+    struct DitherStateType {
+        byte Top;
+        uint32_t Fraction;
+        uint32_t Denominator;
+        uint32_t Accumulator;
+    };
+
     /* Type which includes the Pwm Pins */
     enum PwmPinType {
-        //PWM_PIN_11 = TIMERTWO_A_ARDUINO_PIN,
+        PWM_PIN_11 = TIMERTWO_A_ARDUINO_PIN,
         PWM_PIN_3 = TIMERTWO_B_ARDUINO_PIN
     };
 
+    /* State of a staged update, double buffered compare registers need one period until they are latched */
+    enum UpdateStateType {
+        UPDATE_IDLE,
+        UPDATE_PENDING,
+        UPDATE_LATCHING
+    };
+
+    /* Deferred work item, Function(Context) is called by dispatch() */
+    struct DeferredItemType {
+        TimerIsrCallbackF_pvoid Function;
+        void* Context;
+    };
+
+    /* Statistics of the deferred queue, Overflows counts rejected items and saturates */
+    struct DeferredQueueStatisticsType {
+        uint16_t Overflows;
+        byte HighWaterMark;
+    };
+
+    /* Overruns counts interrupts which ended with the next tick already pending, MissedTicks the callback periods
+       an elapsed callback was called late for, both saturate */
+    struct OverrunStatisticsType {
+        uint16_t Overruns;
+        uint16_t MissedTicks;
+    };
+
+#if TIMERTWO_STATISTICS
+    /* Statistics of the timer tick in timer counts, latency is the counter position at interrupt entry (counts since
+       BOTTOM), callback duration the counts from interrupt entry to the return of the callback */
+    struct Stats {
+        uint32_t Ticks;
+        uint32_t Callbacks;
+        uint16_t LatencyMin;
+        uint16_t LatencyMax;
+        uint16_t CallbackMin;
+        uint16_t CallbackMax;
+        uint16_t LatencyHistogram[TIMERTWO_STATISTICS_BINS];
+        uint16_t CallbackHistogram[TIMERTWO_STATISTICS_BINS];
+    };
+#endif
+
+    /* Shadow values of a staged update, Mask holds the staged parts (TIMERTWO_UPDATE_...) */
+    struct UpdateType {
+        byte Mask;
+        ClockSelectType ClockSelectBitGroup;
+        byte Top;
+        byte PreviousTop;
+        uint16_t Postscaler;
+        uint32_t PeriodCycles;
+        TimeType PeriodMicroseconds;
+        byte DutyCycleA;
+        byte DutyCycleB;
+        byte OcrA;
+        byte OcrB;
+    };
+
+    /* Stopwatch in CPU cycles, needs initStopwatch(). The overhead of the measurement itself is subtracted */
+    class Stopwatch
+    {
+        uint32_t StartCycles;
+        uint32_t LapCycles;
+
+      public:
+        /* Named code section, min, average and max of all measurements of the section */
+        struct Section {
+            const char* Name;
+            uint32_t Count;
+            uint32_t Min;
+            uint32_t Max;
+            uint64_t Total;
+
+            explicit Section(const char* sName) : Name(sName) { reset(); }
+            void reset() { Count = 0u; Min = UINT32_MAX; Max = 0u; Total = 0u; }
+            void add(uint32_t Cycles) {
+                Count++;
+                Total += Cycles;
+                if(Cycles < Min) { Min = Cycles; }
+                if(Cycles > Max) { Max = Cycles; }
+            }
+            uint32_t getAverage() const { return (Count != 0u) ? static_cast<uint32_t>(Total / Count) : 0u; }
+        };
+
+        /* Measures the lifetime of the object and adds it to the section */
+        class Scope
+        {
+            Section& ScopeSection;
+            uint32_t StartCycles;
+
+          public:
+            explicit Scope(Section&);
+            ~Scope();
+        };
+
+        Stopwatch() : StartCycles(0u), LapCycles(0u) { }
+        void start();
+        uint32_t lap();
+        uint32_t elapsedCycles() const;
+    };
+
 /******************************************************************************************************************************************************
  *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
 ******************************************************************************************************************************************************/
@@ -119,12 +422,84 @@ class TimerTwo
     TimerTwo(const TimerTwo&);
 
     TimerIsrCallbackF_void TimerIsrOverflowCallback;
+    /* callback with context, only called if no callback without context is attached */
+    TimerIsrCallbackF_pvoid TimerIsrContextCallback;
+    void* TimerIsrCallbackContext;
+    /* callback with elapsed periods, periods which elapse while it runs are passed to the next call */
+    TimerIsrCallbackF_uint16 TimerIsrElapsedCallback;
+    volatile uint16_t ElapsedTicks;
+    volatile bool ElapsedCallbackActive;
+    volatile OverrunStatisticsType OverrunStatistics;
     StateType State;
     ClockSelectType ClockSelectBitGroup;
+    TimeType PeriodMicroseconds;
+    /* hardware periods per callback, counted down in the overflow interrupt */
+    uint16_t Postscaler;
+    volatile uint16_t PostscalerCount;
+    /* monotonic clock in CPU cycles, advanced by one timer period in the overflow interrupt */
+    volatile uint32_t ClockTicksLow;
+    volatile uint32_t ClockTicksHigh;
+    volatile uint32_t PeriodCycles;
+    /* TOP dithering, OCR2A alternates between Top and Top + 1 */
+    bool Dithering;
+    DitherStateType DitherState;
+    uint32_t DitherStepCycles;
+    /* if OCR2A is double buffered, the value written at BOTTOM is active in the next period */
+    bool DitherLongActive;
+    bool DitherLongPending;
+    /* deferred queue, single producer (interrupt context) and single consumer (dispatch()), the free running
+       indices are only written by their owner */
+    DeferredItemType DeferredQueue[TIMERTWO_DEFERRED_QUEUE_SIZE];
+    volatile byte DeferredHead;
+    volatile byte DeferredTail;
+    volatile DeferredQueueStatisticsType DeferredStatistics;
+#if TIMERTWO_STATISTICS
+    Stats Statistics;
+    byte TickEntryCount;
+#endif
+    /* cycles of an empty stopwatch measurement, measured by initStopwatch() */
+    byte StopwatchOverhead;
+    /* staged update, applied at BOTTOM by the overflow interrupt */
+    UpdateType Update;
+    volatile UpdateStateType UpdateState;
     
     // methods
     byte getPrescaleShiftScale();
-    byte getTimerCycles(TimeType);
+    byte getTimerCycles(TimeType, uint16_t&, ClockSelectType&);
+    void getFixedTopCycles(TimeType, uint16_t&, ClockSelectType&);
+    StdReturnType getDitherCycles(TimeType, uint16_t&, DitherStateType&, ClockSelectType&);
+    byte getActiveTop() {
+        if(Dithering) { return DitherState.Top + DitherLongActive; }
+        /* a new TOP which is not latched yet can already be read back from OCR2A */
+        if((UPDATE_LATCHING == UpdateState) && (Update.Mask & TIMERTWO_UPDATE_PERIOD)) { return Update.PreviousTop; }
+        return OCR2A;
+    }
+    bool isClockRunning() const { return Reg::Cs2::read() != REG_CS_NO_CLOCK; }
+    void latchCompareRegisters();
+    void applyPeriod(byte, ClockSelectType, uint16_t, TimeType, const DitherStateType&);
+    uint32_t getActivePeriodCycles() { return Dithering ? ((DitherState.Top + WaveformPolicy::TOP_OFFSET + DitherLongActive) * DitherStepCycles) : PeriodCycles; }
+#if TIMERTWO_STATISTICS
+    static void addStatisticsSample(uint16_t Sample, uint16_t& Min, uint16_t& Max, uint16_t* Histogram) {
+        uint16_t Bin = Sample >> TIMERTWO_STATISTICS_BIN_SHIFT;
+        if(Sample < Min) { Min = Sample; }
+        if(Sample > Max) { Max = Sample; }
+        if(Bin >= TIMERTWO_STATISTICS_BINS) { Bin = TIMERTWO_STATISTICS_BINS - 1u; }
+        if(Histogram[Bin] != UINT16_MAX) { Histogram[Bin]++; }
+    }
+#endif
+    uint16_t getCounterPosition(bool&);
+    TimeType countsToMicroseconds(uint16_t);
+    uint32_t getClockTicks(uint32_t&);
+    /* the phase correct fixed TOP mode has no flag for TOP, so the counting direction and the position in the period are unknown */
+    static constexpr bool isCounterPositionAvailable() { return !WaveformPolicy::DUAL_SLOPE || WaveformPolicy::TOP_MATCH_FLAG; }
+    /* longest period the hardware can generate with TOP 255 and prescaler 1024 */
+    static constexpr TimeType getHardwarePeriodMax() {
+        return TimeType{(((TIMERTWO_RESOLUTION - 1u + WaveformPolicy::TOP_OFFSET) * TIMERTWO_MAX_PRESCALER) << WaveformPolicy::COUNT_SHIFT) / (F_CPU / 1000000uL)};
+    }
+    /* with the tone generator the hardware period is the sample period, longer periods are made by the postscaler only */
+    static constexpr TimeType getTonePeriodMax() {
+        return TimeType{(static_cast<uint64_t>(TimerTwoPeriodSolver::periodCycles(TimerTwoPeriodSolver::TOP_MAX, TIMERTWO_TONE_CLOCK_SELECT - 1u)) * TIMERTWO_POSTSCALER_MAX) / (F_CPU / 1000000uL)};
+    }
 
 /******************************************************************************************************************************************************
  *  P U B L I C   F U N C T I O N S
@@ -135,28 +510,310 @@ class TimerTwo
     // get methods
     StateType getState() const { return State; }
     TimerIsrCallbackF_void getTimerIsrCallbackFunction() const { return TimerIsrOverflowCallback; }
-    TimeType getPeriodMax() { return TimeType{((TIMERTWO_RESOLUTION / (F_CPU / 1000000uL)) * TIMERTWO_MAX_PRESCALER * 2u) - 1u}; }
+    uint16_t getPostscaler() const { return Postscaler; }
+    bool isDithering() const { return Dithering; }
+    bool isUpdatePending() const { return UpdateState != UPDATE_IDLE; }
+    /* timer counts since StartCount was read in the tick interrupt, the counter may have passed TOP once. In phase
+       correct mode the compare match flag of TOP, which the tick clears, tells the counting direction, the counter is
+       read before the flag, so TOP can not pass unnoticed in between */
+    uint16_t getCountsSince(byte StartCount) {
+        byte Count = TCNT2;
+        uint16_t Top = WaveformPolicy::FIXED_TOP ? (TIMERTWO_RESOLUTION - 1u) : getActiveTop();
+        if(WaveformPolicy::DUAL_SLOPE && WaveformPolicy::TOP_MATCH_FLAG) {
+            if(Reg::Tifr2::readBit<OCF2A>()) { return (Top - StartCount) + (Top - Count); }
+            return Count - StartCount;
+        }
+        if(Count >= StartCount) { return Count - StartCount; }
+        if(WaveformPolicy::DUAL_SLOPE) { return (Top - StartCount) + (Top - Count); }
+        return (Top + 1u - StartCount) + Count;
+    }
+    DitherStateType getDitherState();
+    uint64_t getActualPeriodNs();
+    int32_t getPeriodErrorNs();
+    /* longest period without postscaler, the hardware period with TOP 255 and prescaler 1024 */
+    static constexpr TimeType getPeriodMax() { return getHardwarePeriodMax(); }
+    static constexpr TimeType getPostscaledPeriodMax() {
+        return TIMERTWO_TONE_VOICES ? getTonePeriodMax() :
+               (((static_cast<uint64_t>(getHardwarePeriodMax()) * TIMERTWO_POSTSCALER_MAX) > UINT32_MAX) ? UINT32_MAX : (getHardwarePeriodMax() * TIMERTWO_POSTSCALER_MAX));
+    }
     // set methods
 
     // methods
     StdReturnType init(TimeType = 1000uL, TimerIsrCallbackF_void = nullptr);
     StdReturnType setPeriod(TimeType);
+#if (TIMERTWO_TONE_VOICES == 0u)
+    /* not available with the tone generator, it keeps the sample rate and sets the period with the postscaler */
+    template<TimeType Microseconds> StdReturnType init(TimerIsrCallbackF_void = nullptr);
+    template<TimeType Microseconds> StdReturnType setPeriod();
+#endif
     StdReturnType enablePwm(PwmPinType, byte);
     StdReturnType disablePwm(PwmPinType);
     StdReturnType setPwmDuty(PwmPinType, byte);
+    StdReturnType stagePeriod(TimeType);
+    StdReturnType stagePwmDuty(PwmPinType, byte);
+    StdReturnType commitUpdate();
+    StdReturnType enableDithering();
+    StdReturnType disableDithering();
+    StdReturnType initStopwatch();
     StdReturnType start();
     void stop();
     StdReturnType resume();
     StdReturnType attachInterrupt(TimerIsrCallbackF_void);
+    StdReturnType attachInterrupt(TimerIsrCallbackF_pvoid, void*);
+    template<class Type, void (Type::*Method)()> StdReturnType attachInterrupt(Type& Object) { return attachInterrupt(&callMethod<Type, Method>, &Object); }
+    StdReturnType attachElapsedInterrupt(TimerIsrCallbackF_uint16);
     void detachInterrupt();
     StdReturnType read(TimeType&);
-    void callTimerIsrOverflowCallback() { TimerIsrOverflowCallback(); }
+    byte dispatch();
+    DeferredQueueStatisticsType getDeferredQueueStatistics();
+    void resetDeferredQueueStatistics();
+    OverrunStatisticsType getOverrunStatistics();
+    void resetOverrunStatistics();
+#if TIMERTWO_STATISTICS
+    void getStats(Stats&);
+    void resetStats();
+#endif
+    StdReturnType readTicks(uint32_t&);
+    StdReturnType readTicks(uint64_t&);
+    StdReturnType readMicros(uint32_t&);
+    StdReturnType readMicros(uint64_t&);
+    void updateDithering() {
+        /* the period which just ended was generated with the TOP written two interrupts before, one without buffering */
+        PeriodCycles = getActivePeriodCycles();
+        DitherLongActive = DitherLongPending;
+        uint32_t Accumulator = DitherState.Accumulator + DitherState.Fraction;
+        DitherLongPending = (Accumulator >= DitherState.Denominator);
+        if(DitherLongPending) { Accumulator -= DitherState.Denominator; }
+        DitherState.Accumulator = Accumulator;
+        OCR2A = DitherState.Top + DitherLongPending;
+        if(!WaveformPolicy::OCR_BUFFERED) { DitherLongActive = DitherLongPending; }
+    }
+    void updateShadowRegisters() {
+        if(UPDATE_PENDING == UpdateState) {
+            /* phase 1: compare registers, double buffered ones are latched by the hardware until the next BOTTOM */
+            if(Update.Mask & TIMERTWO_UPDATE_PERIOD) {
+                Update.PreviousTop = OCR2A;
+                if(!WaveformPolicy::FIXED_TOP) { OCR2A = Update.Top; }
+            }
+            if(Update.Mask & TIMERTWO_UPDATE_DUTY_A) { OCR2A = Update.OcrA; }
+            if(Update.Mask & TIMERTWO_UPDATE_DUTY_B) { OCR2B = Update.OcrB; }
+            UpdateState = UPDATE_LATCHING;
+            if(WaveformPolicy::OCR_BUFFERED) { return; }
+        }
+        /* phase 2: the new compare values are active from this BOTTOM on, so switch the prescaler and the period */
+        if(Update.Mask & TIMERTWO_UPDATE_PERIOD) {
+            if(isClockRunning()) { Reg::Cs2::write(Update.ClockSelectBitGroup); }
+            ClockSelectBitGroup = Update.ClockSelectBitGroup;
+            PeriodMicroseconds = Update.PeriodMicroseconds;
+            PeriodCycles = Update.PeriodCycles;
+            Postscaler = Update.Postscaler;
+            PostscalerCount = Update.Postscaler;
+        }
+        Update.Mask = 0u;
+        UpdateState = UPDATE_IDLE;
+    }
+    void updateClock() { uint32_t TicksLow = ClockTicksLow + PeriodCycles; if(TicksLow < PeriodCycles) { ClockTicksHigh = ClockTicksHigh + 1u; } ClockTicksLow = TicksLow; }
+    bool updatePostscaler() { uint16_t Count = PostscalerCount - 1u; if(Count != 0u) { PostscalerCount = Count; return false; } PostscalerCount = Postscaler; return true; }
+    /* timer tick at BOTTOM, returns true if the postscaled period is over and the callback is due */
+    bool updateTick() __attribute__((always_inline)) {
+#if TIMERTWO_STATISTICS
+        TickEntryCount = TCNT2;
+        Statistics.Ticks++;
+        addStatisticsSample(TickEntryCount, Statistics.LatencyMin, Statistics.LatencyMax, Statistics.LatencyHistogram);
+#endif
+        /* clear compare match flag of TOP so read() can find out the counting direction */
+        if(WaveformPolicy::DUAL_SLOPE && WaveformPolicy::TOP_MATCH_FLAG) { Reg::Tifr2::write<Reg::Ocf2a::Value<1u> >(); }
+        if(Dithering) { updateDithering(); }
+        updateClock();
+        if(UpdateState != UPDATE_IDLE) { updateShadowRegisters(); }
+        return updatePostscaler();
+    }
+    /* overflow of the stopwatch, TIMERTWO_STOPWATCH_ISR() */
+    void updateStopwatch() { ClockTicksLow = ClockTicksLow + TIMERTWO_RESOLUTION; }
+    /* duration of the callback */
+    void updateCallbackStatistics() {
+#if TIMERTWO_STATISTICS
+        uint16_t Duration = getCountsSince(TickEntryCount);
+        Statistics.Callbacks++;
+        addStatisticsSample(Duration, Statistics.CallbackMin, Statistics.CallbackMax, Statistics.CallbackHistogram);
+#endif
+    }
+    void callTimerIsrOverflowCallback() {
+        if(TimerIsrOverflowCallback != nullptr) { TimerIsrOverflowCallback(); }
+        else if(TimerIsrContextCallback != nullptr) { TimerIsrContextCallback(TimerIsrCallbackContext); }
+        else if(TimerIsrElapsedCallback != nullptr) { callTimerIsrElapsedCallback(); }
+    }
+    void callTimerIsrElapsedCallback();
+    /* the next tick is already pending at the end of the interrupt */
+    void checkOverrun() {
+        if(Reg::Tifr2::readBit<WaveformPolicy::TICK_FLAG>() && (OverrunStatistics.Overruns != UINT16_MAX)) { OverrunStatistics.Overruns = OverrunStatistics.Overruns + 1u; }
+    }
+    /* queue work for dispatch() in main context, called from Timer2 interrupt context only */
+    StdReturnType defer(TimerIsrCallbackF_pvoid Function, void* Context = nullptr) {
+        byte Head = DeferredHead;
+        byte Count = Head - DeferredTail;
+        if(nullptr == Function) { return E_NOT_OK; }
+        if(Count >= TIMERTWO_DEFERRED_QUEUE_SIZE) {
+            if(DeferredStatistics.Overflows != UINT16_MAX) { DeferredStatistics.Overflows = DeferredStatistics.Overflows + 1u; }
+            return E_NOT_OK;
+        }
+        DeferredItemType& Item = DeferredQueue[Head & (TIMERTWO_DEFERRED_QUEUE_SIZE - 1u)];
+        Item.Function = Function;
+        Item.Context = Context;
+        TIMERTWO_MEMORY_BARRIER();
+        DeferredHead = Head + 1u;
+        if(++Count > DeferredStatistics.HighWaterMark) { DeferredStatistics.HighWaterMark = Count; }
+        return E_OK;
+    }
+    byte getStopwatchOverhead() const { return StopwatchOverhead; }
+    /* CPU cycles since initStopwatch(), the counter counts CPU cycles and the clock is advanced by 256 per overflow */
+    uint32_t getStopwatchCycles() {
+        if(WaveformPolicy::DUAL_SLOPE) { uint32_t Ticks = 0u; readTicks(Ticks); return Ticks; }
+        uint8_t SregSave = SREG;
+        cli();
+        byte Count = TCNT2;
+        uint32_t Cycles = ClockTicksLow;
+        /* overflow not handled yet, read the counter again, it has wrapped around for sure */
+        if(Reg::Tifr2::readBit<WaveformPolicy::TICK_FLAG>()) { Count = TCNT2; Cycles += TIMERTWO_RESOLUTION; }
+        SREG = SregSave;
+        return Cycles + Count;
+    }
+    byte getDeferredCount() const { return static_cast<byte>(DeferredHead - DeferredTail); }
+    /* delegate of a member function, the call of the method is inlined into it */
+    template<class Type, void (Type::*Method)()> static void callMethod(void* Object) { (static_cast<Type*>(Object)->*Method)(); }
       
 };
 
 /* TimerTwo will be pre-instantiated in TimerTwo source file */
 extern TimerTwo& Timer2;
 
+
+/******************************************************************************************************************************************************
+ *  S T O P W A T C H   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+inline void TimerTwo::Stopwatch::start()
+{
+    StartCycles = Timer2.getStopwatchCycles();
+    LapCycles = StartCycles;
+}
+
+/* cycles since the last lap() or start() */
+inline uint32_t TimerTwo::Stopwatch::lap()
+{
+    uint32_t Cycles = Timer2.getStopwatchCycles();
+    uint32_t Lap = Cycles - LapCycles - Timer2.getStopwatchOverhead();
+    LapCycles = Cycles;
+    return Lap;
+}
+
+/* cycles since start() */
+inline uint32_t TimerTwo::Stopwatch::elapsedCycles() const
+{
+    return Timer2.getStopwatchCycles() - StartCycles - Timer2.getStopwatchOverhead();
+}
+
+inline TimerTwo::Stopwatch::Scope::Scope(Section& sSection) : ScopeSection(sSection)
+{
+    StartCycles = Timer2.getStopwatchCycles();
+}
+
+inline TimerTwo::Stopwatch::Scope::~Scope()
+{
+    ScopeSection.add(Timer2.getStopwatchCycles() - StartCycles - Timer2.getStopwatchOverhead());
+}
+
+
+#if (TIMERTWO_TONE_VOICES == 0u)
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoConfig
+ *****************************************************************************************************************************************************/
+/*! \brief          compile time configuration of the Timer2 period
+ *  \details        calculates prescaler and TOP value with the same solver setPeriod() uses at runtime. Periods out of
+ *                  bounds are rejected by the compiler.
+ *****************************************************************************************************************************************************/
+template<TimerTwo::TimeType Microseconds>
+class TimerTwoConfig
+{
+    static_assert(Microseconds > 0u, "TimerTwo period has to be at least 1 microsecond");
+    static_assert(Microseconds <= TimerTwo::getPeriodMax(), "TimerTwo period is greater than the hardware period getPeriodMax(), use setPeriod() for postscaled periods");
+
+    static constexpr uint32_t Cycles = TimerTwoPeriodSolver::cycles(Microseconds);
+    static constexpr byte PrescalerIndex = TimerTwoPeriodSolver::bestIndex(Cycles);
+
+  public:
+    static constexpr TimerTwo::ClockSelectType ClockSelectBitGroup = static_cast<TimerTwo::ClockSelectType>(PrescalerIndex + 1u);
+    static constexpr byte PrescaleShiftScale = TimerTwoPeriodSolver::prescaleShiftScale(PrescalerIndex);
+
+    /* OCR2A is TOP, except in the fixed TOP modes */
+    static constexpr byte Top = TimerTwoPeriodSolver::top(Cycles, PrescalerIndex);
+
+    /* achieved period */
+    static constexpr uint32_t PeriodCycles = TimerTwoPeriodSolver::periodCycles(Top, PrescalerIndex);
+    static constexpr uint32_t ActualPeriodNs = static_cast<uint32_t>(TimerTwoPeriodSolver::nanoseconds(PeriodCycles));
+    static constexpr int32_t PeriodErrorNs = static_cast<int32_t>(ActualPeriodNs) - static_cast<int32_t>(Microseconds * 1000uL);
+};
+
+
+/******************************************************************************************************************************************************
+ *  T E M P L A T E   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  init()
+******************************************************************************************************************************************************/
+/*! \brief          initialization of the Timer2 hardware with a period known at compile time
+ *  \details        prescaler and TOP value are calculated by TimerTwoConfig, so no solver runs at runtime. The registers
+ *                  and the period state are written like by init(). Example: Timer2.init<1000>(timerCallback);
+ *
+ *  \param[in]      sTimerOverflowCallback      Callback function which should be called when timer overflow interrupt occurs
+ *  \return         E_OK
+ *                  E_NOT_OK - TimerTwo is already initialized
+ *  \pre            Timer has to be in NONE state
+ *****************************************************************************************************************************************************/
+template<TimerTwo::TimeType Microseconds>
+StdReturnType TimerTwo::init(TimerIsrCallbackF_void sTimerOverflowCallback)
+{
+    typedef TimerTwoConfig<Microseconds> Config;
+
+    if(STATE_INIT == State) {
+        /* set waveform generation mode, clock stays disabled until start() */
+        Reg::Tccr2a::write<Reg::Wgm2a::Value<(WaveformPolicy::WGM & Reg::Wgm2a::MAX)> >();
+        Reg::Tccr2b::write<Reg::Wgm2b::Value<(WaveformPolicy::WGM >> 2u)>, Reg::Cs2::Value<REG_CS_NO_CLOCK> >();
+        /* the same period state as the runtime init() */
+        applyPeriod(Config::Top, Config::ClockSelectBitGroup, 1u, Microseconds, DitherState);
+        if(sTimerOverflowCallback != nullptr) { attachInterrupt(sTimerOverflowCallback); }
+        State = STATE_IDLE;
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* init */
+
+
+/******************************************************************************************************************************************************
+  setPeriod()
+******************************************************************************************************************************************************/
+/*! \brief          set period of Timer2 overflow interrupt known at compile time
+ *  \details        Example: Timer2.setPeriod<500>(); Dithering is disabled. Like setPeriod() a staged update has to be
+ *                  complete before.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - staged update still pending
+ *****************************************************************************************************************************************************/
+template<TimerTwo::TimeType Microseconds>
+StdReturnType TimerTwo::setPeriod()
+{
+    typedef TimerTwoConfig<Microseconds> Config;
+
+    if(isUpdatePending()) { return E_NOT_OK; }
+    uint8_t SregSave = SREG;
+    cli();
+    Dithering = false;
+    SREG = SregSave;
+    applyPeriod(Config::Top, Config::ClockSelectBitGroup, 1u, Microseconds, DitherState);
+    return E_OK;
+} /* setPeriod */
+#endif
+
 #endif
 
 /******************************************************************************************************************************************************
@@ -0,0 +1,390 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoBam.cpp
+ *      \brief      Source file of the TimerTwo bit angle modulation LED matrix driver
+ *
+ *      \details    A pixel with the value V is on for V of the 255 plane units of its row. The driver owns Timer2, it
+ *                  defines the compare match A interrupt, so the tick of the TimerTwo class is not available. The
+ *                  refresh rate and the interrupt load per matrix size are listed in README.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOBAM_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoBam.h"
+
+#if TIMERTWO_BAM_ROWS
+
+/******************************************************************************************************************************************************
+ *  LOCAL DATA TYPES AND STRUCTURES
+ *****************************************************************************************************************************************************/
+typedef TimerTwoRegisters Reg;
+
+/* prescaler as power of two, indexed by the clock select bit group */
+static const byte PrescalerShift[8] = { 0u, 0u, 3u, 5u, 6u, 7u, 8u, 10u };
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoBam& Timer2Bam = TimerTwoBam::getInstance();      // pre-instantiate TimerTwoBam
+
+
+/******************************************************************************************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************************************************************************************/
+/* port index 0 is PORTB, 1 is PORTC and 2 is PORTD */
+static inline void writePins(const byte* KeepMask, const byte* SetMask)
+{
+    Reg::Portb::write((Reg::Portb::read() & KeepMask[0u]) | SetMask[0u]);
+    Reg::Portc::write((Reg::Portc::read() & KeepMask[1u]) | SetMask[1u]);
+    Reg::Portd::write((Reg::Portd::read() & KeepMask[2u]) | SetMask[2u]);
+}
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoBam
+******************************************************************************************************************************************************/
+TimerTwoBam::TimerTwoBam()
+{
+    for(byte Port = 0u; Port < TIMERTWOBAM_NUMBER_OF_PORTS; Port++) {
+        RowKeep[Port] = 0xFFu;
+        RowOff[Port] = 0u;
+        ColumnKeep[Port] = 0xFFu;
+        ColumnOff[Port] = 0u;
+    }
+    ActiveFrame = 0u;
+    UpdatePending = false;
+    PlaneCycles = 0u;
+    Row = 0u;
+    Plane = 0u;
+    Initialized = false;
+    Running = false;
+    clear();
+} /* TimerTwoBam */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoBam
+******************************************************************************************************************************************************/
+TimerTwoBam::~TimerTwoBam()
+{
+
+} /* ~TimerTwoBam */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoBam& TimerTwoBam::getInstance()
+{
+    static TimerTwoBam SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getFrameRate()
+******************************************************************************************************************************************************/
+/*! \brief          get the frame rate set by begin()
+ *
+ *  \return         frames per second, 0 if the driver is not running
+ *****************************************************************************************************************************************************/
+uint16_t TimerTwoBam::getFrameRate() const
+{
+    if(!Running) { return 0u; }
+    return F_CPU / (static_cast<uint32_t>(TIMERTWOBAM_ROW_UNITS) * PlaneCycles * TIMERTWO_BAM_ROWS);
+} /* getFrameRate */
+
+
+/******************************************************************************************************************************************************
+  init()
+******************************************************************************************************************************************************/
+/*! \brief          configure the pins of the matrix
+ *  \details        all pins are configured as outputs and switched off. A row is selected by its row pin, a pixel is lit
+ *                  if its row is selected and its column pin is on. The pixels are cleared.
+ *
+ *  \param[in]      RowPins                 TIMERTWO_BAM_ROWS Arduino pins of PORTB, PORTC or PORTD
+ *  \param[in]      ColumnPins              TIMERTWO_BAM_COLUMNS Arduino pins of PORTB, PORTC or PORTD
+ *  \param[in]      RowActiveLow            a row is selected by LOW
+ *  \param[in]      ColumnActiveLow         a column is on by LOW
+ *  \return         E_OK
+ *                  E_NOT_OK - driver is running or invalid pin
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoBam::init(const byte* RowPins, const byte* ColumnPins, bool RowActiveLow, bool ColumnActiveLow)
+{
+    byte Port, Mask;
+    byte RowMask[TIMERTWOBAM_NUMBER_OF_PORTS] = { 0u, 0u, 0u };
+    byte ColumnMask[TIMERTWOBAM_NUMBER_OF_PORTS] = { 0u, 0u, 0u };
+
+    if(Running) { return E_NOT_OK; }
+    for(byte Index = 0u; Index < TIMERTWO_BAM_ROWS; Index++) {
+        if(getPin(RowPins[Index], Port, Mask) == E_NOT_OK) { return E_NOT_OK; }
+        RowMask[Port] |= Mask;
+    }
+    for(byte Index = 0u; Index < TIMERTWO_BAM_COLUMNS; Index++) {
+        if(getPin(ColumnPins[Index], Port, Mask) == E_NOT_OK) { return E_NOT_OK; }
+        ColumnMask[Port] |= Mask;
+        ColumnPort[Index] = Port;
+        ColumnPinMask[Index] = Mask;
+    }
+
+    for(Port = 0u; Port < TIMERTWOBAM_NUMBER_OF_PORTS; Port++) {
+        RowKeep[Port] = ~RowMask[Port];
+        RowOff[Port] = RowActiveLow ? RowMask[Port] : 0u;
+        ColumnKeep[Port] = ~ColumnMask[Port];
+        ColumnOff[Port] = ColumnActiveLow ? ColumnMask[Port] : 0u;
+    }
+    for(byte Index = 0u; Index < TIMERTWO_BAM_ROWS; Index++) {
+        getPin(RowPins[Index], Port, Mask);
+        for(byte sPort = 0u; sPort < TIMERTWOBAM_NUMBER_OF_PORTS; sPort++) { RowSelect[Index][sPort] = RowOff[sPort]; }
+        RowSelect[Index][Port] ^= Mask;
+    }
+
+    writePins(ColumnKeep, ColumnOff);
+    writePins(RowKeep, RowOff);
+    for(byte Index = 0u; Index < TIMERTWO_BAM_ROWS; Index++) { pinMode(RowPins[Index], OUTPUT); }
+    for(byte Index = 0u; Index < TIMERTWO_BAM_COLUMNS; Index++) { pinMode(ColumnPins[Index], OUTPUT); }
+
+    Initialized = true;
+    clear();
+    return show();
+} /* init */
+
+
+/******************************************************************************************************************************************************
+  begin()
+******************************************************************************************************************************************************/
+/*! \brief          start the multiplexing
+ *  \details        The plane unit is the longest power of two CPU cycles which gives at least the requested frame rate,
+ *                  it is set by the prescaler and the length of plane 0 (one or two timer counts). Timer2 is configured
+ *                  for CTC mode and the compare match A interrupt is enabled, the first frame starts with the next
+ *                  interrupt.
+ *
+ *  \param[in]      FrameRate               minimum frames per second, the result is returned by getFrameRate()
+ *  \return         E_OK
+ *                  E_NOT_OK - not initialized, already running or FrameRate above getFrameRateMax()
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoBam::begin(uint16_t FrameRate)
+{
+    if(!Initialized || Running || (0u == FrameRate)) { return E_NOT_OK; }
+
+    uint32_t UnitCycles = F_CPU / (static_cast<uint32_t>(FrameRate) * TIMERTWOBAM_ROW_UNITS * TIMERTWO_BAM_ROWS);
+    byte ClockSelect = 0u;
+    byte BaseShift = 0u;
+    byte UnitShift = 0u;
+
+    /* longest unit first, plane 0 of two counts is preferred, so OCR2A is never 0 */
+    for(byte Shift = PrescalerShift[7u] + 1u; (Shift > 0u) && (0u == ClockSelect); Shift--) {
+        if((1ul << Shift) > UnitCycles) { continue; }
+        for(byte Cs = 7u; Cs > 0u; Cs--) {
+            if(PrescalerShift[Cs] + 1u == Shift) { ClockSelect = Cs; BaseShift = 1u; break; }
+            if(PrescalerShift[Cs] == Shift) { ClockSelect = Cs; BaseShift = 0u; }
+        }
+        UnitShift = Shift;
+    }
+    if((0u == ClockSelect) || ((1ul << UnitShift) < TIMERTWOBAM_MIN_PLANE_CYCLES)) { return E_NOT_OK; }
+
+    PlaneCycles = 1u << UnitShift;
+    for(byte Index = 0u; Index < TIMERTWOBAM_NUMBER_OF_PLANES; Index++) { PlaneTop[Index] = static_cast<byte>((1u << (Index + BaseShift)) - 1u); }
+
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Timsk2::write(0u);
+    Reg::Tccr2a::write<Reg::Wgm2a::Value<(TimerTwo::WaveformPolicy::WGM & Reg::Wgm2a::MAX)> >();
+    Reg::Tccr2b::write<Reg::Wgm2b::Value<(TimerTwo::WaveformPolicy::WGM >> 2u)>, Reg::Cs2::Value<TimerTwo::REG_CS_NO_CLOCK> >();
+    TCNT2 = 0u;
+    OCR2A = PlaneTop[0u];
+    Row = 0u;
+    Plane = 0u;
+    UpdatePending = false;
+    Reg::Tifr2::write<Reg::Tov2::Value<1u>, Reg::Ocf2a::Value<1u>, Reg::Ocf2b::Value<1u> >();
+    Reg::Ocie2a::write<1u>();
+    Reg::Cs2::write(ClockSelect);
+    Running = true;
+    SREG = SregSave;
+    return E_OK;
+} /* begin */
+
+
+/******************************************************************************************************************************************************
+  end()
+******************************************************************************************************************************************************/
+/*! \brief          stop the multiplexing and Timer2, all rows and columns are switched off
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoBam::end()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Ocie2a::write<0u>();
+    Reg::Cs2::write<TimerTwo::REG_CS_NO_CLOCK>();
+    writePins(ColumnKeep, ColumnOff);
+    writePins(RowKeep, RowOff);
+    Running = false;
+    SREG = SregSave;
+    /* a pending frame is applied, so show() finds the latest pixels in the active frame */
+    if(UpdatePending) {
+        ActiveFrame ^= 1u;
+        UpdatePending = false;
+    }
+} /* end */
+
+
+/******************************************************************************************************************************************************
+  clear()
+******************************************************************************************************************************************************/
+/*! \brief          set all pixels to 0, it is shown by show()
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoBam::clear()
+{
+    for(byte sRow = 0u; sRow < TIMERTWO_BAM_ROWS; sRow++) {
+        for(byte Column = 0u; Column < TIMERTWO_BAM_COLUMNS; Column++) { Pixels[sRow][Column] = 0u; }
+    }
+} /* clear */
+
+
+/******************************************************************************************************************************************************
+  show()
+******************************************************************************************************************************************************/
+/*! \brief          show the pixels from the beginning of the next frame
+ *  \details        the frame is built in the inactive buffer, a pending frame which is not active yet is replaced. So a
+ *                  frame never shows parts of two pixel states.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - pins are not initialized
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoBam::show()
+{
+    if(!Initialized) { return E_NOT_OK; }
+    if(!Running) {
+        buildFrame(Frames[ActiveFrame]);
+        return E_OK;
+    }
+
+    uint8_t SregSave = SREG;
+    cli();
+    UpdatePending = false;
+    SREG = SregSave;
+    /* the interrupt does not touch the inactive buffer while no update is pending */
+    buildFrame(Frames[ActiveFrame ^ 1u]);
+    UpdatePending = true;
+    return E_OK;
+} /* show */
+
+
+/******************************************************************************************************************************************************
+  updateMatrix()
+******************************************************************************************************************************************************/
+/*! \brief          compare match A interrupt
+ *  \details        The counter has restarted at the compare match, so OCR2A is set to the length of the starting plane
+ *                  first: it has to be written before the counter passes it, within one plane unit at plane 0. At
+ *                  plane 0 the columns are switched off, the next row is selected and at row 0 a pending frame becomes
+ *                  active. Then the columns of the plane are written.
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoBam::updateMatrix()
+{
+    byte CurrentPlane = Plane;
+    byte CurrentRow = Row;
+
+    OCR2A = PlaneTop[CurrentPlane];
+    if(0u == CurrentPlane) {
+        if((0u == CurrentRow) && UpdatePending) {
+            ActiveFrame ^= 1u;
+            UpdatePending = false;
+        }
+        /* columns off before the row changes, otherwise the last plane of the previous row ghosts into this row */
+        writePins(ColumnKeep, ColumnOff);
+        writePins(RowKeep, RowSelect[CurrentRow]);
+    }
+    writePins(ColumnKeep, Frames[ActiveFrame].Columns[CurrentRow][CurrentPlane]);
+
+    if(++CurrentPlane == TIMERTWOBAM_NUMBER_OF_PLANES) {
+        CurrentPlane = 0u;
+        if(++CurrentRow == TIMERTWO_BAM_ROWS) { CurrentRow = 0u; }
+        Row = CurrentRow;
+    }
+    Plane = CurrentPlane;
+} /* updateMatrix */
+
+
+/******************************************************************************************************************************************************
+ * P R I V A T E   F U N C T I O N S
+******************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getPin()
+******************************************************************************************************************************************************/
+/*! \brief          get port index and mask of a pin
+ *  \return         E_OK
+ *                  E_NOT_OK - pin is not on PORTB, PORTC or PORTD
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoBam::getPin(byte Pin, byte& Port, byte& Mask)
+{
+    Port = digitalPinToPort(Pin);
+    if((Port < PB) || (Port > PD)) { return E_NOT_OK; }
+    Port -= PB;
+    Mask = digitalPinToBitMask(Pin);
+    return E_OK;
+}
+
+/******************************************************************************************************************************************************
+  buildFrame()
+******************************************************************************************************************************************************/
+/*! \brief          convert the pixels to the port values of the column pins
+ *  \details        the column pin of a pixel is on in plane b if bit b of the pixel value is set
+ *
+ *  \param[out]     Frame                   frame to build
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoBam::buildFrame(FrameType& Frame)
+{
+    for(byte sRow = 0u; sRow < TIMERTWO_BAM_ROWS; sRow++) {
+        for(byte sPlane = 0u; sPlane < TIMERTWOBAM_NUMBER_OF_PLANES; sPlane++) {
+            byte* Columns = Frame.Columns[sRow][sPlane];
+            for(byte Port = 0u; Port < TIMERTWOBAM_NUMBER_OF_PORTS; Port++) { Columns[Port] = ColumnOff[Port]; }
+            for(byte Column = 0u; Column < TIMERTWO_BAM_COLUMNS; Column++) {
+                if(Pixels[sRow][Column] & (1u << sPlane)) { Columns[ColumnPort[Column]] ^= ColumnPinMask[Column]; }
+            }
+        }
+    }
+}
+
+
+/******************************************************************************************************************************************************
+ * I N T E R R U P T   S E R V I C E   R O U T I N E
+ *****************************************************************************************************************************************************/
+/* replaces the weak tick interrupt of TimerTwo.cpp */
+ISR(TIMER2_COMPA_vect)
+{
+    Timer2Bam.updateMatrix();
+}
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
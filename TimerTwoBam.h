@@ -0,0 +1,140 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoBam.h
+ *      \brief      Header file of the TimerTwo bit angle modulation LED matrix driver
+ *
+ *      \details    Multiplexed LED matrix with 8 bit brightness per pixel. Each row is shown for 8 bit planes, plane b
+ *                  lasts 2^b plane units, so a row takes 8 interrupts instead of 256. Timer2 runs in CTC mode and the
+ *                  compare match A interrupt sets OCR2A to the length of the next plane. The pixels are converted to
+ *                  port values per row and plane by show(), the interrupt only writes them to the ports. This
+ *                  framebuffer is double buffered and swapped at the end of a frame.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOBAM_H_
+#define _TIMERTWOBAM_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+
+#if TIMERTWO_BAM_ROWS
+
+#if (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_CTC)
+# error "TimerTwo: the BAM driver needs TIMERTWO_MODE_CTC, OCR2A has to take effect immediately"
+#endif
+#if TIMERTWO_SOFTPWM_CHANNELS
+# error "TimerTwo: the BAM driver changes TOP in every interrupt, it can not be used together with the software PWM"
+#endif
+#if ((TIMERTWO_BAM_ROWS + TIMERTWO_BAM_COLUMNS) > 24u) || (TIMERTWO_BAM_COLUMNS == 0u)
+# error "TimerTwo: the BAM matrix needs 1 to 24 pins of PORTB, PORTC and PORTD for rows and columns"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+#define TIMERTWOBAM_NUMBER_OF_PLANES                8u
+/* ports B, C and D */
+#define TIMERTWOBAM_NUMBER_OF_PORTS                 3u
+/* shortest plane unit in CPU cycles: OCR2A is not buffered in CTC mode, the interrupt of plane 0 has to write its TOP
+ * (1 or 0) within one unit after the compare match, or the counter passes it and plane 0 lasts 256 counts longer */
+#ifndef TIMERTWOBAM_MIN_PLANE_CYCLES
+# define TIMERTWOBAM_MIN_PLANE_CYCLES               128u
+#endif
+/* one row takes 255 plane units */
+#define TIMERTWOBAM_ROW_UNITS                       ((1u << TIMERTWOBAM_NUMBER_OF_PLANES) - 1u)
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoBam
+ *****************************************************************************************************************************************************/
+class TimerTwoBam
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    /* port values of the column pins of all rows and planes */
+    struct FrameType {
+        byte Columns[TIMERTWO_BAM_ROWS][TIMERTWOBAM_NUMBER_OF_PLANES][TIMERTWOBAM_NUMBER_OF_PORTS];
+    };
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoBam();
+    ~TimerTwoBam();
+    TimerTwoBam(const TimerTwoBam&);
+
+    byte Pixels[TIMERTWO_BAM_ROWS][TIMERTWO_BAM_COLUMNS];
+    /* inverted masks of all row and column pins, the port values of the pins if they are off and of each selected row */
+    byte RowKeep[TIMERTWOBAM_NUMBER_OF_PORTS];
+    byte RowOff[TIMERTWOBAM_NUMBER_OF_PORTS];
+    byte RowSelect[TIMERTWO_BAM_ROWS][TIMERTWOBAM_NUMBER_OF_PORTS];
+    byte ColumnKeep[TIMERTWOBAM_NUMBER_OF_PORTS];
+    byte ColumnOff[TIMERTWOBAM_NUMBER_OF_PORTS];
+    /* port index and mask of each column pin */
+    byte ColumnPort[TIMERTWO_BAM_COLUMNS];
+    byte ColumnPinMask[TIMERTWO_BAM_COLUMNS];
+    /* double buffered framebuffer, the interrupt switches to the other one at the end of a frame if UpdatePending is set */
+    FrameType Frames[2];
+    volatile byte ActiveFrame;
+    volatile bool UpdatePending;
+    /* OCR2A of each plane, a plane unit is PlaneCycles CPU cycles */
+    byte PlaneTop[TIMERTWOBAM_NUMBER_OF_PLANES];
+    uint16_t PlaneCycles;
+    /* row and plane which start with the next interrupt */
+    byte Row;
+    byte Plane;
+    bool Initialized;
+    bool Running;
+
+    // methods
+    static StdReturnType getPin(byte, byte&, byte&);
+    void buildFrame(FrameType&);
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoBam& getInstance();
+
+    // get methods
+    bool isRunning() const { return Running; }
+    bool isUpdatePending() const { return UpdatePending; }
+    byte getPixel(byte sRow, byte Column) const { return ((sRow < TIMERTWO_BAM_ROWS) && (Column < TIMERTWO_BAM_COLUMNS)) ? Pixels[sRow][Column] : 0u; }
+    uint16_t getFrameRate() const;
+    static uint16_t getFrameRateMax() { return F_CPU / (static_cast<uint32_t>(TIMERTWOBAM_ROW_UNITS) * TIMERTWOBAM_MIN_PLANE_CYCLES * TIMERTWO_BAM_ROWS); }
+
+    // set methods
+    void setPixel(byte sRow, byte Column, byte Value) { if((sRow < TIMERTWO_BAM_ROWS) && (Column < TIMERTWO_BAM_COLUMNS)) { Pixels[sRow][Column] = Value; } }
+
+    // methods
+    StdReturnType init(const byte*, const byte*, bool = false, bool = false);
+    StdReturnType begin(uint16_t);
+    void end();
+    void clear();
+    StdReturnType show();
+    void updateMatrix();
+};
+
+/* TimerTwoBam will be pre-instantiated in TimerTwoBam source file */
+extern TimerTwoBam& Timer2Bam;
+
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,231 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoDds.cpp
+ *      \brief      Source file of the TimerTwo direct digital synthesis
+ *
+ *      \details    The output frequency is PhaseIncrement * SampleRate / 2^32. The phase accumulator is never reset by a
+ *                  change of the frequency or of the wavetable, so the waveform continues without a jump. The driver owns
+ *                  Timer2, it defines the overflow interrupt, so the tick of the TimerTwo class is not available.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWODDS_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoDds.h"
+
+#if TIMERTWO_DDS
+
+/******************************************************************************************************************************************************
+ *  LOCAL DATA TYPES AND STRUCTURES
+ *****************************************************************************************************************************************************/
+typedef TimerTwoRegisters Reg;
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoDds& Timer2Dds = TimerTwoDds::getInstance();      // pre-instantiate TimerTwoDds
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoDds
+******************************************************************************************************************************************************/
+TimerTwoDds::TimerTwoDds()
+{
+    Wavetable = TimerTwoWavetableSine;
+    Phase = 0u;
+    PhaseIncrement = 0u;
+    Running = false;
+} /* TimerTwoDds */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoDds
+******************************************************************************************************************************************************/
+TimerTwoDds::~TimerTwoDds()
+{
+
+} /* ~TimerTwoDds */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoDds& TimerTwoDds::getInstance()
+{
+    static TimerTwoDds SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getFrequency()
+******************************************************************************************************************************************************/
+/*! \brief          get the output frequency
+ *  \details        the phase increment is an integer, so the result can differ from the set frequency by up to half the
+ *                  resolution of SampleRate / 2^32
+ *
+ *  \return         frequency in milli-Hertz
+ *****************************************************************************************************************************************************/
+uint32_t TimerTwoDds::getFrequency() const
+{
+    uint8_t SregSave = SREG;
+    cli();
+    uint32_t Increment = PhaseIncrement;
+    SREG = SregSave;
+    return static_cast<uint32_t>(((static_cast<uint64_t>(Increment) * SAMPLE_RATE_MILLIHZ) + (1uLL << 31u)) >> 32u);
+} /* getFrequency */
+
+
+/******************************************************************************************************************************************************
+  setFrequency()
+******************************************************************************************************************************************************/
+/*! \brief          set the output frequency
+ *  \details        the phase increment is written atomically and the phase continues, so the next sample already has the
+ *                  new frequency and the waveform has no jump.
+ *
+ *  \param[in]      FrequencyMilliHz        frequency in milli-Hertz, up to half the sample rate
+ *  \return         E_OK
+ *                  E_NOT_OK - frequency above half the sample rate
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoDds::setFrequency(uint32_t FrequencyMilliHz)
+{
+    if(FrequencyMilliHz > (SAMPLE_RATE_MILLIHZ / 2u)) { return E_NOT_OK; }
+
+    /* calculated outside of the atomic section, the 64 bit division takes several hundred cycles */
+    uint32_t Increment = static_cast<uint32_t>(((static_cast<uint64_t>(FrequencyMilliHz) << 32u) + (SAMPLE_RATE_MILLIHZ / 2u)) / SAMPLE_RATE_MILLIHZ);
+
+    uint8_t SregSave = SREG;
+    cli();
+    PhaseIncrement = Increment;
+    SREG = SregSave;
+    return E_OK;
+} /* setFrequency */
+
+
+/******************************************************************************************************************************************************
+  setWavetable()
+******************************************************************************************************************************************************/
+/*! \brief          change the waveform, the phase continues
+ *
+ *  \param[in]      sWavetable              TIMERTWO_WAVETABLE_SIZE samples in program memory
+ *  \return         E_OK
+ *                  E_NOT_OK - no wavetable given
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoDds::setWavetable(const byte* sWavetable)
+{
+    if(NULL == sWavetable) { return E_NOT_OK; }
+
+    uint8_t SregSave = SREG;
+    cli();
+    Wavetable = sWavetable;
+    SREG = SregSave;
+    return E_OK;
+} /* setWavetable */
+
+
+/******************************************************************************************************************************************************
+  begin()
+******************************************************************************************************************************************************/
+/*! \brief          start the waveform output on pin 3
+ *  \details        Timer2 is configured for the waveform mode with TOP 0xFF and TIMERTWO_DDS_CLOCK_SELECT, OC2B is
+ *                  enabled non-inverting and the overflow interrupt writes one sample per period. The phase starts at 0.
+ *
+ *  \param[in]      sWavetable              TIMERTWO_WAVETABLE_SIZE samples in program memory, e. g. TimerTwoWavetableSine
+ *  \param[in]      FrequencyMilliHz        frequency in milli-Hertz, up to half the sample rate
+ *  \return         E_OK
+ *                  E_NOT_OK - already running, no wavetable given or frequency above half the sample rate
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoDds::begin(const byte* sWavetable, uint32_t FrequencyMilliHz)
+{
+    if(Running || (setWavetable(sWavetable) == E_NOT_OK) || (setFrequency(FrequencyMilliHz) == E_NOT_OK)) { return E_NOT_OK; }
+
+    pinMode(TIMERTWO_B_ARDUINO_PIN, OUTPUT);
+
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Timsk2::write(0u);
+    Reg::Tccr2a::write<Reg::Wgm2a::Value<(TimerTwo::WaveformPolicy::WGM & Reg::Wgm2a::MAX)>, Reg::Com2b::Value<Reg::COM_NON_INVERTING> >();
+    Reg::Tccr2b::write<Reg::Wgm2b::Value<(TimerTwo::WaveformPolicy::WGM >> 2u)>, Reg::Cs2::Value<TimerTwo::REG_CS_NO_CLOCK> >();
+    TCNT2 = 0u;
+    Phase = 0u;
+    OCR2B = pgm_read_byte(&Wavetable[0u]);
+    Reg::Tifr2::write<Reg::Tov2::Value<1u>, Reg::Ocf2a::Value<1u>, Reg::Ocf2b::Value<1u> >();
+    Reg::Toie2::write<1u>();
+    Reg::Cs2::write<TIMERTWO_DDS_CLOCK_SELECT>();
+    Running = true;
+    SREG = SregSave;
+    return E_OK;
+} /* begin */
+
+
+/******************************************************************************************************************************************************
+  end()
+******************************************************************************************************************************************************/
+/*! \brief          stop Timer2 and the waveform output, pin 3 is cleared
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoDds::end()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Toie2::write<0u>();
+    Reg::Cs2::write<TimerTwo::REG_CS_NO_CLOCK>();
+    Reg::Com2b::write<0u>();
+    Running = false;
+    SREG = SregSave;
+    digitalWrite(TIMERTWO_B_ARDUINO_PIN, LOW);
+} /* end */
+
+
+/******************************************************************************************************************************************************
+  updateSample()
+******************************************************************************************************************************************************/
+/*! \brief          overflow interrupt
+ *  \details        OCR2B is double buffered in the PWM modes, the sample written here becomes active at the next update
+ *                  of the compare register, so the interrupt latency does not cause jitter.
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoDds::updateSample()
+{
+    uint32_t NextPhase = Phase + PhaseIncrement;
+
+    Phase = NextPhase;
+    OCR2B = pgm_read_byte(&Wavetable[static_cast<byte>(NextPhase >> TIMERTWODDS_PHASE_SHIFT)]);
+} /* updateSample */
+
+
+/******************************************************************************************************************************************************
+ * I N T E R R U P T   S E R V I C E   R O U T I N E
+ *****************************************************************************************************************************************************/
+/* replaces the weak tick interrupt of TimerTwo.cpp */
+ISR(TIMER2_OVF_vect)
+{
+    Timer2Dds.updateSample();
+}
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,101 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoDds.h
+ *      \brief      Header file of the TimerTwo direct digital synthesis
+ *
+ *      \details    Arbitrary waveform output on pin 3 (OC2B). Timer2 runs in an 8 bit PWM mode with a fixed sample rate,
+ *                  the overflow interrupt adds the phase increment to a 32 bit phase accumulator and writes the wavetable
+ *                  entry of the upper 8 bits to OCR2B. The frequency is given in milli-Hertz.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWODDS_H_
+#define _TIMERTWODDS_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+#include "TimerTwoWavetable.h"
+
+#if TIMERTWO_DDS
+
+#if (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_FAST_PWM_8BIT) && (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_PHASE_CORRECT_8BIT)
+# error "TimerTwo: DDS needs TIMERTWO_MODE_FAST_PWM_8BIT or TIMERTWO_MODE_PHASE_CORRECT_8BIT, the sample rate has to be independent of OCR2A"
+#endif
+#if (TIMERTWO_DDS_CLOCK_SELECT < 1u) || (TIMERTWO_DDS_CLOCK_SELECT > 7u)
+# error "TimerTwo: TIMERTWO_DDS_CLOCK_SELECT has to be 1 to 7"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* the wavetable is indexed by the upper 8 bits of the phase */
+#define TIMERTWODDS_PHASE_SHIFT                     24u
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoDds
+ *****************************************************************************************************************************************************/
+class TimerTwoDds
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    /* one sample per Timer2 period with TOP 0xFF */
+    static constexpr uint32_t SAMPLE_CYCLES = TimerTwoPeriodSolver::periodCycles(TimerTwoPeriodSolver::TOP_MAX, TIMERTWO_DDS_CLOCK_SELECT - 1u);
+    static constexpr uint64_t SAMPLE_RATE_MILLIHZ = (static_cast<uint64_t>(F_CPU) * 1000uLL) / SAMPLE_CYCLES;
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoDds();
+    ~TimerTwoDds();
+    TimerTwoDds(const TimerTwoDds&);
+
+    const byte* Wavetable;
+    uint32_t Phase;
+    uint32_t PhaseIncrement;
+    bool Running;
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoDds& getInstance();
+
+    // get methods
+    bool isRunning() const { return Running; }
+    uint32_t getFrequency() const;
+    static uint32_t getSampleRate() { return static_cast<uint32_t>(SAMPLE_RATE_MILLIHZ / 1000u); }
+
+    // set methods
+    StdReturnType setFrequency(uint32_t);
+    StdReturnType setWavetable(const byte*);
+
+    // methods
+    StdReturnType begin(const byte*, uint32_t);
+    void end();
+    void updateSample();
+};
+
+/* TimerTwoDds will be pre-instantiated in TimerTwoDds source file */
+extern TimerTwoDds& Timer2Dds;
+
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,50 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoHal.h
+ *      \brief      Hardware abstraction of TimerTwo library
+ *
+ *      \details    On AVR the registers, interrupt macros and Arduino functions are taken from avr-libc and the Arduino core.
+ *                  On other targets the host backend (TimerTwoHost.h) provides the same names with a cycle stepped model
+ *                  of Timer2, so the library sources can be compiled and run unmodified.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWO_HAL_H_
+#define _TIMERTWO_HAL_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#if defined(__AVR__)
+# include "Arduino.h"
+# include <avr/io.h>
+# include <avr/interrupt.h>
+#else
+# include "TimerTwoHost.h"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* data memory addresses of the Timer2 and port registers (ATmega48/88/168/328), used as template parameters by TimerTwoRegister.h */
+#define TIMERTWO_ADDRESS_PORTB                      0x25u
+#define TIMERTWO_ADDRESS_PORTC                      0x28u
+#define TIMERTWO_ADDRESS_PORTD                      0x2Bu
+#define TIMERTWO_ADDRESS_TIFR2                      0x37u
+#define TIMERTWO_ADDRESS_TIMSK2                     0x70u
+#define TIMERTWO_ADDRESS_TCCR2A                     0xB0u
+#define TIMERTWO_ADDRESS_TCCR2B                     0xB1u
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
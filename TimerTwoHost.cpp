@@ -0,0 +1,588 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoHost.cpp
+ *      \brief      Source file of the TimerTwo host backend
+ *
+ *      \details    The counter is stepped timer clock by timer clock, the CPU cycles between two timer clocks are skipped at
+ *                  once. Interrupt flags and compare outputs change in the timer clock in which the counter leaves the
+ *                  value which caused them: compare match when leaving OCR2x, overflow when leaving MAX (TOP in fast PWM
+ *                  modes) or BOTTOM in phase correct modes. Double buffered compare registers are latched at BOTTOM in
+ *                  fast PWM modes and at TOP in phase correct modes. Force output compare and the asynchronous
+ *                  operation are not modeled.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOHOST_SOURCE_
+
+#if !defined(__AVR__)
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoHost.h"
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+#define TIMERTWOHOST_MAX                            0xFFu
+#define TIMERTWOHOST_PRESCALER_MASK                 0x3FFu
+
+/* compare output modes */
+#define TIMERTWOHOST_COM_DISCONNECTED               0u
+#define TIMERTWOHOST_COM_TOGGLE                     1u
+#define TIMERTWOHOST_COM_CLEAR                      2u
+#define TIMERTWOHOST_COM_SET                        3u
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL DATA TYPES AND STRUCTURES
+ *****************************************************************************************************************************************************/
+/* weak references, so only the vectors defined with ISR() are called */
+extern "C" void __vector_7(void) __attribute__((weak));
+extern "C" void __vector_8(void) __attribute__((weak));
+extern "C" void __vector_9(void) __attribute__((weak));
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoHost& Timer2Host = TimerTwoHost::getInstance();      // pre-instantiate TimerTwoHost
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoHost
+******************************************************************************************************************************************************/
+TimerTwoHost::TimerTwoHost()
+{
+    reset();
+} /* TimerTwoHost */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoHost
+******************************************************************************************************************************************************/
+TimerTwoHost::~TimerTwoHost()
+{
+
+} /* ~TimerTwoHost */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoHost& TimerTwoHost::getInstance()
+{
+    static TimerTwoHost SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  reset()
+******************************************************************************************************************************************************/
+/*! \brief          reset the model to the power on state
+ *  \details        all registers are 0, global interrupts are enabled like after Arduino init()
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoHost::reset()
+{
+    Cycles = 0u;
+    PrescalerCount = 0u;
+    Tccr2a = 0u;
+    Tccr2b = 0u;
+    Tcnt2 = 0u;
+    Timsk2 = 0u;
+    Tifr2 = 0u;
+    Gtccr = 0u;
+    Assr = 0u;
+    Sreg = _BV(SREG_I);
+    CountingUp = true;
+    CompareBlocked = false;
+    for(byte Channel = 0u; Channel < TIMERTWOHOST_NUMBER_OF_CHANNELS; Channel++) {
+        OcrBuffer[Channel] = 0u;
+        Ocr[Channel] = 0u;
+        Output[Channel] = false;
+    }
+    for(byte Vector = 0u; Vector < 3u; Vector++) { InterruptCount[Vector] = 0u; }
+    for(byte Index = 0u; Index < TIMERTWOHOST_NUMBER_OF_PORTS; Index++) { Port[Index] = 0u; }
+    resetOutputStatistics();
+} /* reset */
+
+
+/******************************************************************************************************************************************************
+  step()
+******************************************************************************************************************************************************/
+/*! \brief          advance the model
+ *  \details        the model runs the given CPU cycles of the calling context. Interrupt service routines are called
+ *                  when a flag is set, the interrupt is enabled and global interrupts are enabled, their runtime is added
+ *                  to the given cycles like on the target.
+ *
+ *  \param[in]      StepCycles              CPU cycles to run
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoHost::step(uint32_t StepCycles)
+{
+    while(StepCycles > 0u) {
+        uint16_t Prescaler = getPrescaler();
+        uint32_t CyclesToTick = (0u == Prescaler) ? StepCycles : (Prescaler - (PrescalerCount & (Prescaler - 1u)));
+
+        if(CyclesToTick > StepCycles) { CyclesToTick = StepCycles; }
+        Cycles += CyclesToTick;
+        PrescalerCount = (PrescalerCount + CyclesToTick) & TIMERTWOHOST_PRESCALER_MASK;
+        StepCycles -= CyclesToTick;
+        if((Prescaler != 0u) && ((PrescalerCount & (Prescaler - 1u)) == 0u)) {
+            tick();
+            dispatchInterrupts();
+        }
+    }
+} /* step */
+
+
+/******************************************************************************************************************************************************
+  readRegister()
+******************************************************************************************************************************************************/
+uint8_t TimerTwoHost::readRegister(byte Address)
+{
+    step(TIMERTWOHOST_ACCESS_CYCLES);
+
+    switch(Address)
+    {
+        case TIMERTWOHOST_ADDRESS_TIFR2:
+            return Tifr2;
+        case TIMERTWOHOST_ADDRESS_GTCCR:
+            return Gtccr;
+        case TIMERTWOHOST_ADDRESS_SREG:
+            return Sreg;
+        case TIMERTWOHOST_ADDRESS_TIMSK2:
+            return Timsk2;
+        case TIMERTWOHOST_ADDRESS_TCCR2A:
+            return Tccr2a;
+        case TIMERTWOHOST_ADDRESS_TCCR2B:
+            /* force output compare bits are always read as zero */
+            return Tccr2b & ~(_BV(FOC2A) | _BV(FOC2B));
+        case TIMERTWOHOST_ADDRESS_TCNT2:
+            return Tcnt2;
+        case TIMERTWOHOST_ADDRESS_OCR2A:
+            return OcrBuffer[TIMERTWOHOST_CHANNEL_A];
+        case TIMERTWOHOST_ADDRESS_OCR2B:
+            return OcrBuffer[TIMERTWOHOST_CHANNEL_B];
+        case TIMERTWOHOST_ADDRESS_ASSR:
+            return Assr;
+        case TIMERTWOHOST_ADDRESS_PORTB:
+            return Port[PB - PB];
+        case TIMERTWOHOST_ADDRESS_PORTC:
+            return Port[PC - PB];
+        case TIMERTWOHOST_ADDRESS_PORTD:
+            return Port[PD - PB];
+        default:
+            return 0u;
+    }
+} /* readRegister */
+
+
+/******************************************************************************************************************************************************
+  writeRegister()
+******************************************************************************************************************************************************/
+void TimerTwoHost::writeRegister(byte Address, uint8_t Value)
+{
+    step(TIMERTWOHOST_ACCESS_CYCLES);
+
+    switch(Address)
+    {
+        case TIMERTWOHOST_ADDRESS_TIFR2:
+            /* flags are cleared by writing a logical one */
+            Tifr2 &= ~Value;
+            break;
+        case TIMERTWOHOST_ADDRESS_GTCCR:
+            /* PSRASY resets the prescaler, it stays set while TSM is set */
+            if(Value & _BV(PSRASY)) { PrescalerCount = 0u; }
+            Gtccr = Value & (_BV(TSM) | ((Value & _BV(TSM)) ? _BV(PSRASY) : 0u));
+            break;
+        case TIMERTWOHOST_ADDRESS_SREG:
+            Sreg = Value;
+            break;
+        case TIMERTWOHOST_ADDRESS_TIMSK2:
+            Timsk2 = Value & (_BV(TOIE2) | _BV(OCIE2A) | _BV(OCIE2B));
+            break;
+        case TIMERTWOHOST_ADDRESS_TCCR2A:
+            Tccr2a = Value;
+            break;
+        case TIMERTWOHOST_ADDRESS_TCCR2B:
+            Tccr2b = Value;
+            break;
+        case TIMERTWOHOST_ADDRESS_TCNT2:
+            Tcnt2 = Value;
+            CompareBlocked = true;
+            break;
+        case TIMERTWOHOST_ADDRESS_OCR2A:
+        case TIMERTWOHOST_ADDRESS_OCR2B:
+        {
+            byte Channel = (TIMERTWOHOST_ADDRESS_OCR2A == Address) ? TIMERTWOHOST_CHANNEL_A : TIMERTWOHOST_CHANNEL_B;
+            OcrBuffer[Channel] = Value;
+            if(!isBuffered()) { Ocr[Channel] = Value; }
+            break;
+        }
+        case TIMERTWOHOST_ADDRESS_ASSR:
+            Assr = Value;
+            break;
+        case TIMERTWOHOST_ADDRESS_PORTB:
+            writePort(PB - PB, Value);
+            break;
+        case TIMERTWOHOST_ADDRESS_PORTC:
+            writePort(PC - PB, Value);
+            break;
+        case TIMERTWOHOST_ADDRESS_PORTD:
+            writePort(PD - PB, Value);
+            break;
+        default:
+            break;
+    }
+    dispatchInterrupts();
+} /* writeRegister */
+
+
+/******************************************************************************************************************************************************
+  disableInterrupts()
+******************************************************************************************************************************************************/
+void TimerTwoHost::disableInterrupts()
+{
+    step(TIMERTWOHOST_ACCESS_CYCLES);
+    Sreg &= ~_BV(SREG_I);
+} /* disableInterrupts */
+
+
+/******************************************************************************************************************************************************
+  enableInterrupts()
+******************************************************************************************************************************************************/
+void TimerTwoHost::enableInterrupts()
+{
+    step(TIMERTWOHOST_ACCESS_CYCLES);
+    Sreg |= _BV(SREG_I);
+    dispatchInterrupts();
+} /* enableInterrupts */
+
+
+/******************************************************************************************************************************************************
+  getOutputHighCycles()
+******************************************************************************************************************************************************/
+/*! \brief          get CPU cycles the compare output was high
+ *  \details        together with getCycles() the duty cycle of OC2A and OC2B can be measured. The output is modeled
+ *                  independent of the data direction register.
+ *
+ *  \param[in]      Channel                 TIMERTWOHOST_CHANNEL_A or TIMERTWOHOST_CHANNEL_B
+ *  \return         high cycles since the last resetOutputStatistics()
+ *****************************************************************************************************************************************************/
+uint64_t TimerTwoHost::getOutputHighCycles(byte Channel)
+{
+    uint64_t HighCycles = OutputHighCycles[Channel];
+    if(Output[Channel]) { HighCycles += Cycles - OutputChanged[Channel]; }
+    return HighCycles;
+} /* getOutputHighCycles */
+
+
+/******************************************************************************************************************************************************
+  getPinHighCycles()
+******************************************************************************************************************************************************/
+/*! \brief          get CPU cycles the port pin was high
+ *  \details        the output level of PORTB, PORTC and PORTD, independent of the data direction register.
+ *
+ *  \param[in]      Pin                     Arduino pin number
+ *  \return         high cycles since the last resetOutputStatistics()
+ *****************************************************************************************************************************************************/
+uint64_t TimerTwoHost::getPinHighCycles(uint8_t Pin)
+{
+    if(NOT_A_PIN == digitalPinToPort(Pin)) { return 0u; }
+    byte Index = digitalPinToPort(Pin) - PB;
+    byte Bit = 0u;
+    while((digitalPinToBitMask(Pin) >> Bit) != 1u) { Bit++; }
+
+    uint64_t HighCycles = PinHighCycles[Index][Bit];
+    if(Port[Index] & _BV(Bit)) { HighCycles += Cycles - PinChanged[Index][Bit]; }
+    return HighCycles;
+} /* getPinHighCycles */
+
+
+/******************************************************************************************************************************************************
+  resetOutputStatistics()
+******************************************************************************************************************************************************/
+void TimerTwoHost::resetOutputStatistics()
+{
+    for(byte Channel = 0u; Channel < TIMERTWOHOST_NUMBER_OF_CHANNELS; Channel++) {
+        OutputChanged[Channel] = Cycles;
+        OutputHighCycles[Channel] = 0u;
+    }
+    for(byte Index = 0u; Index < TIMERTWOHOST_NUMBER_OF_PORTS; Index++) {
+        for(byte Bit = 0u; Bit < 8u; Bit++) {
+            PinChanged[Index][Bit] = Cycles;
+            PinHighCycles[Index][Bit] = 0u;
+        }
+    }
+} /* resetOutputStatistics */
+
+
+/******************************************************************************************************************************************************
+  getInterruptCount()
+******************************************************************************************************************************************************/
+/*! \brief          get number of calls of an interrupt service routine
+ *
+ *  \param[in]      Isr                     TIMER2_COMPA_vect, TIMER2_COMPB_vect or TIMER2_OVF_vect
+ *  \return         number of calls since reset()
+ *****************************************************************************************************************************************************/
+uint32_t TimerTwoHost::getInterruptCount(IsrF_void Isr) const
+{
+    if(TIMER2_COMPA_vect == Isr) { return InterruptCount[0u]; }
+    if(TIMER2_COMPB_vect == Isr) { return InterruptCount[1u]; }
+    if(TIMER2_OVF_vect == Isr) { return InterruptCount[2u]; }
+    return 0u;
+} /* getInterruptCount */
+
+
+/******************************************************************************************************************************************************
+ * P R I V A T E   F U N C T I O N S
+******************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getPrescaler()
+******************************************************************************************************************************************************/
+inline uint16_t TimerTwoHost::getPrescaler() const
+{
+    switch(Tccr2b & (_BV(CS22) | _BV(CS21) | _BV(CS20)))
+    {
+        case 1u: return 1u;
+        case 2u: return 8u;
+        case 3u: return 32u;
+        case 4u: return 64u;
+        case 5u: return 128u;
+        case 6u: return 256u;
+        case 7u: return 1024u;
+        default: return 0u;
+    }
+}
+
+/******************************************************************************************************************************************************
+  isBuffered()
+******************************************************************************************************************************************************/
+/*! \brief          compare registers are double buffered in the PWM modes
+ *****************************************************************************************************************************************************/
+inline bool TimerTwoHost::isBuffered() const
+{
+    byte Mode = getWaveformMode();
+    return (Mode != 0u) && (Mode != 2u);
+}
+
+/******************************************************************************************************************************************************
+  tick()
+******************************************************************************************************************************************************/
+/*! \brief          one timer clock
+ *****************************************************************************************************************************************************/
+void TimerTwoHost::tick()
+{
+    byte Mode = getWaveformMode();
+    bool TopIsOcrA = (2u == Mode) || (5u == Mode) || (7u == Mode);
+    byte Top = TopIsOcrA ? Ocr[TIMERTWOHOST_CHANNEL_A] : TIMERTWOHOST_MAX;
+    byte Counter = Tcnt2;
+    bool DualSlope = (1u == Mode) || (5u == Mode);
+    bool FastPwm = (3u == Mode) || (7u == Mode);
+    bool Latch = false;
+    byte NextCounter;
+
+    if(DualSlope) {
+        if(CountingUp) {
+            /* turn at TOP, the compare registers are latched */
+            if(Counter >= Top) { CountingUp = false; NextCounter = Counter - 1u; Latch = true; }
+            else { NextCounter = Counter + 1u; }
+        } else {
+            if(0u == Counter) { CountingUp = true; NextCounter = 1u; }
+            else { NextCounter = Counter - 1u; }
+        }
+        /* overflow when leaving BOTTOM */
+        if(0u == Counter) { Tifr2 |= _BV(TOV2); }
+    } else {
+        /* clear at TOP in CTC and fast PWM mode, wrap around at MAX otherwise */
+        NextCounter = (Counter == Top) ? 0u : static_cast<byte>(Counter + 1u);
+        if(FastPwm) {
+            if(Counter == Top) { Tifr2 |= _BV(TOV2); Latch = true; }
+        } else {
+            if(TIMERTWOHOST_MAX == Counter) { Tifr2 |= _BV(TOV2); }
+        }
+    }
+
+    /* dual slope modes latch at TOP before the compare, so an OCR2x changed to TOP already matches there */
+    if(Latch && DualSlope) {
+        Ocr[TIMERTWOHOST_CHANNEL_A] = OcrBuffer[TIMERTWOHOST_CHANNEL_A];
+        Ocr[TIMERTWOHOST_CHANNEL_B] = OcrBuffer[TIMERTWOHOST_CHANNEL_B];
+        Latch = false;
+    }
+
+    if(!CompareBlocked) {
+        bool MovingUp = (NextCounter > Counter);
+        if(Counter == Ocr[TIMERTWOHOST_CHANNEL_A]) { Tifr2 |= _BV(OCF2A); compareMatch(TIMERTWOHOST_CHANNEL_A, MovingUp); }
+        if(Counter == Ocr[TIMERTWOHOST_CHANNEL_B]) { Tifr2 |= _BV(OCF2B); compareMatch(TIMERTWOHOST_CHANNEL_B, MovingUp); }
+    }
+    CompareBlocked = false;
+
+    /* fast PWM outputs are set (non-inverting) or cleared (inverting) at BOTTOM, after the compare match of TOP */
+    if(FastPwm && (Counter == Top)) {
+        for(byte Channel = 0u; Channel < TIMERTWOHOST_NUMBER_OF_CHANNELS; Channel++) {
+            byte Com = (Tccr2a >> ((TIMERTWOHOST_CHANNEL_A == Channel) ? COM2A0 : COM2B0)) & 3u;
+            if(TIMERTWOHOST_COM_CLEAR == Com) { setOutput(Channel, true); }
+            if(TIMERTWOHOST_COM_SET == Com) { setOutput(Channel, false); }
+        }
+    }
+
+    if(Latch) {
+        Ocr[TIMERTWOHOST_CHANNEL_A] = OcrBuffer[TIMERTWOHOST_CHANNEL_A];
+        Ocr[TIMERTWOHOST_CHANNEL_B] = OcrBuffer[TIMERTWOHOST_CHANNEL_B];
+    }
+    Tcnt2 = NextCounter;
+}
+
+/******************************************************************************************************************************************************
+  compareMatch()
+******************************************************************************************************************************************************/
+/*! \brief          compare output action of a compare match
+ *  \details        non PWM modes: toggle, clear or set. Fast PWM: clear (non-inverting) or set (inverting). Phase correct:
+ *                  clear while up-counting and set while down-counting (non-inverting). Toggle in PWM modes is only
+ *                  available for OC2A with WGM22 set.
+ *****************************************************************************************************************************************************/
+void TimerTwoHost::compareMatch(byte Channel, bool MovingUp)
+{
+    byte Mode = getWaveformMode();
+    byte Com = (Tccr2a >> ((TIMERTWOHOST_CHANNEL_A == Channel) ? COM2A0 : COM2B0)) & 3u;
+    bool Pwm = isBuffered();
+
+    if(TIMERTWOHOST_COM_DISCONNECTED == Com) { return; }
+    if(TIMERTWOHOST_COM_TOGGLE == Com) {
+        if(!Pwm || ((TIMERTWOHOST_CHANNEL_A == Channel) && (Mode & 4u))) { setOutput(Channel, !Output[Channel]); }
+        return;
+    }
+    if(!Pwm) {
+        setOutput(Channel, TIMERTWOHOST_COM_SET == Com);
+    } else if((1u == Mode) || (5u == Mode)) {
+        setOutput(Channel, (TIMERTWOHOST_COM_SET == Com) ? MovingUp : !MovingUp);
+    } else {
+        setOutput(Channel, TIMERTWOHOST_COM_SET == Com);
+    }
+}
+
+/******************************************************************************************************************************************************
+  setOutput()
+******************************************************************************************************************************************************/
+void TimerTwoHost::setOutput(byte Channel, bool Level)
+{
+    if(Level != Output[Channel]) {
+        if(Output[Channel]) { OutputHighCycles[Channel] += Cycles - OutputChanged[Channel]; }
+        OutputChanged[Channel] = Cycles;
+        Output[Channel] = Level;
+    }
+}
+
+/******************************************************************************************************************************************************
+  writePort()
+******************************************************************************************************************************************************/
+void TimerTwoHost::writePort(byte Index, byte Value)
+{
+    byte Changed = Port[Index] ^ Value;
+
+    for(byte Bit = 0u; Bit < 8u; Bit++) {
+        if(Changed & _BV(Bit)) {
+            if(Port[Index] & _BV(Bit)) { PinHighCycles[Index][Bit] += Cycles - PinChanged[Index][Bit]; }
+            PinChanged[Index][Bit] = Cycles;
+        }
+    }
+    Port[Index] = Value;
+}
+
+/******************************************************************************************************************************************************
+  dispatchInterrupts()
+******************************************************************************************************************************************************/
+/*! \brief          call the interrupt service routines of pending and enabled interrupts
+ *  \details        the vector with the lowest address has the highest priority. The flag is cleared and global interrupts
+ *                  are disabled while the routine runs, like on the target. If the routine enables interrupts again,
+ *                  nested interrupts are served.
+ *****************************************************************************************************************************************************/
+void TimerTwoHost::dispatchInterrupts()
+{
+    static const byte Flags[3] = { _BV(OCF2A), _BV(OCF2B), _BV(TOV2) };
+    IsrF_void Vectors[3] = { TIMER2_COMPA_vect, TIMER2_COMPB_vect, TIMER2_OVF_vect };
+
+    while((Sreg & _BV(SREG_I)) && (Tifr2 & Timsk2)) {
+        byte Vector = 0u;
+        while((Tifr2 & Timsk2 & Flags[Vector]) == 0u) { Vector++; }
+
+        Tifr2 &= ~Flags[Vector];
+        Sreg &= ~_BV(SREG_I);
+        InterruptCount[Vector]++;
+        step(TIMERTWOHOST_ISR_ENTRY_CYCLES);
+        if(Vectors[Vector] != nullptr) { Vectors[Vector](); }
+        step(TIMERTWOHOST_ISR_EXIT_CYCLES);
+        Sreg |= _BV(SREG_I);
+    }
+}
+
+
+/******************************************************************************************************************************************************
+ * T I M E R T W O H O S T R E G I S T E R   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+TimerTwoHostRegister::operator uint8_t() const
+{
+    return TimerTwoHost::getInstance().readRegister(Address);
+}
+
+const TimerTwoHostRegister& TimerTwoHostRegister::operator=(uint8_t Value) const
+{
+    TimerTwoHost::getInstance().writeRegister(Address, Value);
+    return *this;
+}
+
+
+/******************************************************************************************************************************************************
+ * A R D U I N O   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+static const byte PortAddress[TIMERTWOHOST_NUMBER_OF_PORTS] = { TIMERTWOHOST_ADDRESS_PORTB, TIMERTWOHOST_ADDRESS_PORTC, TIMERTWOHOST_ADDRESS_PORTD };
+
+void pinMode(uint8_t, uint8_t)
+{
+
+}
+
+/* like the Arduino core the port is written with interrupts disabled, the port pins are shared with interrupt routines */
+void digitalWrite(uint8_t Pin, uint8_t Value)
+{
+    if(NOT_A_PIN == digitalPinToPort(Pin)) { return; }
+    TimerTwoHostRegister Register(PortAddress[digitalPinToPort(Pin) - PB]);
+    uint8_t SregSave = SREG;
+    cli();
+    if(LOW == Value) { Register &= ~digitalPinToBitMask(Pin); }
+    else { Register |= digitalPinToBitMask(Pin); }
+    SREG = SregSave;
+}
+
+int digitalRead(uint8_t Pin)
+{
+    if(NOT_A_PIN == digitalPinToPort(Pin)) { return LOW; }
+    return (TimerTwoHostRegister(PortAddress[digitalPinToPort(Pin) - PB]) & digitalPinToBitMask(Pin)) ? HIGH : LOW;
+}
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
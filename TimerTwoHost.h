@@ -0,0 +1,293 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoHost.h
+ *      \brief      Host backend of TimerTwo library
+ *
+ *      \details    Model of the ATmega328P Timer/Counter2 for builds on a PC (e. g. Linux with g++). The registers are proxy
+ *                  objects with the avr-libc names, every access advances the model by TIMERTWOHOST_ACCESS_CYCLES CPU
+ *                  cycles. The model counts with the selected prescaler, implements all waveform generation modes with
+ *                  double buffered compare registers, sets the interrupt flags, drives the compare outputs OC2A and OC2B
+ *                  and calls the interrupt service routines defined with ISR().
+ *                  Only included by TimerTwoHal.h if the target is not AVR.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWO_HOST_H_
+#define _TIMERTWO_HOST_H_
+
+#if defined(__AVR__)
+# error "TimerTwoHost.h is the host backend, use TimerTwoHal.h"
+#endif
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include <stdint.h>
+#include <stddef.h>
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+#ifndef F_CPU
+# define F_CPU                                      16000000uL
+#endif
+
+/* CPU cycles of one register access, instruction timing is not modeled */
+#ifndef TIMERTWOHOST_ACCESS_CYCLES
+# define TIMERTWOHOST_ACCESS_CYCLES                 1u
+#endif
+/* interrupt response and return (4 + 3 cycles response and jump, 4 cycles reti) */
+#define TIMERTWOHOST_ISR_ENTRY_CYCLES               7u
+#define TIMERTWOHOST_ISR_EXIT_CYCLES                4u
+
+/* data memory addresses of the modeled registers */
+#define TIMERTWOHOST_ADDRESS_PORTB                  0x25u
+#define TIMERTWOHOST_ADDRESS_PORTC                  0x28u
+#define TIMERTWOHOST_ADDRESS_PORTD                  0x2Bu
+#define TIMERTWOHOST_ADDRESS_TIFR2                  0x37u
+#define TIMERTWOHOST_ADDRESS_GTCCR                  0x43u
+#define TIMERTWOHOST_ADDRESS_SREG                   0x5Fu
+#define TIMERTWOHOST_ADDRESS_TIMSK2                 0x70u
+#define TIMERTWOHOST_ADDRESS_TCCR2A                 0xB0u
+#define TIMERTWOHOST_ADDRESS_TCCR2B                 0xB1u
+#define TIMERTWOHOST_ADDRESS_TCNT2                  0xB2u
+#define TIMERTWOHOST_ADDRESS_OCR2A                  0xB3u
+#define TIMERTWOHOST_ADDRESS_OCR2B                  0xB4u
+#define TIMERTWOHOST_ADDRESS_ASSR                   0xB6u
+
+/* compare output channels */
+#define TIMERTWOHOST_CHANNEL_A                      0u
+#define TIMERTWOHOST_CHANNEL_B                      1u
+#define TIMERTWOHOST_NUMBER_OF_CHANNELS             2u
+
+/* output ports B, C and D */
+#define TIMERTWOHOST_NUMBER_OF_PORTS                3u
+
+/* register bits, see avr/iom328p.h */
+#define TOV2                                        0
+#define OCF2A                                       1
+#define OCF2B                                       2
+#define TOIE2                                       0
+#define OCIE2A                                      1
+#define OCIE2B                                      2
+#define WGM20                                       0
+#define WGM21                                       1
+#define COM2B0                                      4
+#define COM2B1                                      5
+#define COM2A0                                      6
+#define COM2A1                                      7
+#define CS20                                        0
+#define CS21                                        1
+#define CS22                                        2
+#define WGM22                                       3
+#define FOC2B                                       6
+#define FOC2A                                       7
+#define PSRASY                                      1
+#define TSM                                         7
+#define SREG_I                                      7
+
+/* Arduino core */
+#define INPUT                                       0x0
+#define OUTPUT                                      0x1
+#define LOW                                         0x0
+#define HIGH                                        0x1
+#define B111                                        7
+#define NOT_A_PIN                                   0
+#define PB                                          2
+#define PC                                          3
+#define PD                                          4
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL FUNCTION MACROS
+ *****************************************************************************************************************************************************/
+#ifndef _BV
+# define _BV(Bit)                                   (1u << (Bit))
+#endif
+
+/* program memory is ordinary memory on the host, like avr/pgmspace.h */
+#define PROGMEM
+#define pgm_read_byte(Address)                      (*reinterpret_cast<const uint8_t*>(Address))
+
+/* registers, _SFR_MEM8() accesses a register by its data memory address like avr/sfr_defs.h */
+#define _SFR_MEM8(Address)                          (TimerTwoHostRegister(Address))
+#define TIFR2                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_TIFR2))
+#define GTCCR                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_GTCCR))
+#define SREG                                        (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_SREG))
+#define TIMSK2                                      (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_TIMSK2))
+#define TCCR2A                                      (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_TCCR2A))
+#define TCCR2B                                      (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_TCCR2B))
+#define TCNT2                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_TCNT2))
+#define OCR2A                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_OCR2A))
+#define OCR2B                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_OCR2B))
+#define ASSR                                        (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_ASSR))
+#define PORTB                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_PORTB))
+#define PORTC                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_PORTC))
+#define PORTD                                       (TimerTwoHostRegister(TIMERTWOHOST_ADDRESS_PORTD))
+
+/* pin mapping of the Arduino Uno: pin 0 to 7 PORTD, 8 to 13 PORTB, 14 to 19 (A0 to A5) PORTC */
+#define digitalPinToPort(Pin)                       (((Pin) < 8u) ? PD : (((Pin) < 14u) ? PB : (((Pin) < 20u) ? PC : NOT_A_PIN)))
+#define digitalPinToBitMask(Pin)                    _BV(((Pin) < 8u) ? (Pin) : (((Pin) < 14u) ? ((Pin) - 8u) : ((Pin) - 14u)))
+
+/* interrupt vectors, named like the avr-libc vector functions */
+#define TIMER2_COMPA_vect                           __vector_7
+#define TIMER2_COMPB_vect                           __vector_8
+#define TIMER2_OVF_vect                             __vector_9
+#define ISR(Vector, ...)                            extern "C" void Vector(void) __VA_ARGS__; extern "C" void Vector(void)
+
+#define cli()                                       (TimerTwoHost::getInstance().disableInterrupts())
+#define sei()                                       (TimerTwoHost::getInstance().enableInterrupts())
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL DATA TYPES AND STRUCTURES
+ *****************************************************************************************************************************************************/
+typedef uint8_t byte;
+typedef bool boolean;
+
+/* interrupt service routines of Timer2 */
+extern "C" void __vector_7(void);
+extern "C" void __vector_8(void);
+extern "C" void __vector_9(void);
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoHostRegister
+ *****************************************************************************************************************************************************/
+/*! \brief          proxy of one modeled register
+ *  \details        reads and writes are forwarded to the model, so side effects like write one to clear of TIFR2 or the
+ *                  double buffering of OCR2A and OCR2B are modeled.
+ *****************************************************************************************************************************************************/
+class TimerTwoHostRegister
+{
+    byte Address;
+
+  public:
+    explicit TimerTwoHostRegister(byte sAddress) : Address(sAddress) { }
+
+    operator uint8_t() const;
+    const TimerTwoHostRegister& operator=(uint8_t) const;
+    const TimerTwoHostRegister& operator=(const TimerTwoHostRegister& Register) const { return operator=(static_cast<uint8_t>(Register)); }
+    const TimerTwoHostRegister& operator|=(uint8_t Value) const { return operator=(static_cast<uint8_t>(*this) | Value); }
+    const TimerTwoHostRegister& operator&=(uint8_t Value) const { return operator=(static_cast<uint8_t>(*this) & Value); }
+    const TimerTwoHostRegister& operator^=(uint8_t Value) const { return operator=(static_cast<uint8_t>(*this) ^ Value); }
+};
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoHost
+ *****************************************************************************************************************************************************/
+class TimerTwoHost
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    /* Interrupt service routine */
+    typedef void (*IsrF_void)(void);
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoHost();
+    ~TimerTwoHost();
+    TimerTwoHost(const TimerTwoHost&);
+
+    uint64_t Cycles;
+    uint16_t PrescalerCount;
+    /* registers, OcrBuffer is the value written by the CPU, Ocr the value used for compare */
+    byte Tccr2a;
+    byte Tccr2b;
+    byte Tcnt2;
+    byte OcrBuffer[TIMERTWOHOST_NUMBER_OF_CHANNELS];
+    byte Ocr[TIMERTWOHOST_NUMBER_OF_CHANNELS];
+    byte Timsk2;
+    byte Tifr2;
+    byte Gtccr;
+    byte Assr;
+    byte Sreg;
+    bool CountingUp;
+    /* a write to TCNT2 blocks the compare match in the next timer clock */
+    bool CompareBlocked;
+    /* compare outputs and the CPU cycles they were high */
+    bool Output[TIMERTWOHOST_NUMBER_OF_CHANNELS];
+    uint64_t OutputChanged[TIMERTWOHOST_NUMBER_OF_CHANNELS];
+    uint64_t OutputHighCycles[TIMERTWOHOST_NUMBER_OF_CHANNELS];
+    uint32_t InterruptCount[3];
+    /* output ports and the CPU cycles each pin was high */
+    byte Port[TIMERTWOHOST_NUMBER_OF_PORTS];
+    uint64_t PinChanged[TIMERTWOHOST_NUMBER_OF_PORTS][8];
+    uint64_t PinHighCycles[TIMERTWOHOST_NUMBER_OF_PORTS][8];
+
+    // methods
+    byte getWaveformMode() const { return (Tccr2a & (_BV(WGM21) | _BV(WGM20))) | ((Tccr2b & _BV(WGM22)) >> 1u); }
+    uint16_t getPrescaler() const;
+    bool isBuffered() const;
+    void tick();
+    void compareMatch(byte, bool);
+    void setOutput(byte, bool);
+    void writePort(byte, byte);
+    void dispatchInterrupts();
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoHost& getInstance();
+
+    // get methods
+    uint64_t getCycles() const { return Cycles; }
+    bool getOutput(byte Channel) const { return Output[Channel]; }
+    uint64_t getOutputHighCycles(byte);
+    uint64_t getPinHighCycles(uint8_t);
+    uint32_t getInterruptCount(IsrF_void) const;
+
+    // methods
+    void reset();
+    void step(uint32_t);
+    void stepMicroseconds(uint32_t Microseconds) { step(Microseconds * (F_CPU / 1000000uL)); }
+    uint8_t readRegister(byte);
+    void writeRegister(byte, uint8_t);
+    void disableInterrupts();
+    void enableInterrupts();
+    void resetOutputStatistics();
+};
+
+/* TimerTwoHost will be pre-instantiated in TimerTwoHost source file */
+extern TimerTwoHost& Timer2Host;
+
+
+/******************************************************************************************************************************************************
+ *  Arduino core functions used by the library
+ *****************************************************************************************************************************************************/
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+
+/* byte output like Print.h, e. g. for TimerTwoProfiler::dump() */
+class Print
+{
+  public:
+    virtual ~Print() { }
+    virtual size_t write(uint8_t) = 0;
+    size_t write(const uint8_t* Buffer, size_t Size) {
+        size_t Count = 0u;
+        while(Size-- != 0u) { Count += write(*Buffer++); }
+        return Count;
+    }
+};
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
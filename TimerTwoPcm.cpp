@@ -0,0 +1,446 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoPcm.cpp
+ *      \brief      Source file of the TimerTwo PCM sample player
+ *
+ *      \details    The sample rate is set by OCR2A with the smallest prescaler which fits, so TOP is as large as possible.
+ *                  When the interrupt reaches the end of a block it switches to the other one, the compare match A
+ *                  interrupt refills the played block from the source. A new source is started with the next prefetch, at most two blocks later. The
+ *                  driver owns Timer2, it defines the overflow interrupt, so the tick of the TimerTwo class is not
+ *                  available.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOPCM_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoPcm.h"
+
+#if TIMERTWO_PCM
+
+/******************************************************************************************************************************************************
+ *  LOCAL DATA TYPES AND STRUCTURES
+ *****************************************************************************************************************************************************/
+typedef TimerTwoRegisters Reg;
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoPcm& Timer2Pcm = TimerTwoPcm::getInstance();      // pre-instantiate TimerTwoPcm
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoPcm
+******************************************************************************************************************************************************/
+TimerTwoPcm::TimerTwoPcm()
+{
+    Source = SOURCE_NONE;
+    ProgmemSamples = nullptr;
+    ProgmemRemaining = 0u;
+    RingHead = 0u;
+    RingTail = 0u;
+    Steps = TIMERTWO_RESOLUTION;
+    ClockSelect = TimerTwo::REG_CS_NO_CLOCK;
+    fillBlock(0u);
+    fillBlock(1u);
+    ActiveBlock = 0u;
+    NextSample = Blocks[0u];
+    BlockEnd = NextSample + BlockLength[0u];
+    SampleBusyCounts = 0u;
+    resetStatistics();
+    Running = false;
+} /* TimerTwoPcm */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoPcm
+******************************************************************************************************************************************************/
+TimerTwoPcm::~TimerTwoPcm()
+{
+
+} /* ~TimerTwoPcm */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoPcm& TimerTwoPcm::getInstance()
+{
+    static TimerTwoPcm SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getSampleRate()
+******************************************************************************************************************************************************/
+/*! \brief          get the achieved sample rate
+ *  \details        the period is a whole number of timer counts, so it can differ from the rate given to begin(), e. g.
+ *                  22050 Hz is played with 21978 Hz at 16 MHz.
+ *
+ *  \return         sample rate in Hertz, 0 if not running
+ *****************************************************************************************************************************************************/
+uint32_t TimerTwoPcm::getSampleRate() const
+{
+    if(!Running) { return 0u; }
+    return F_CPU / TimerTwoPeriodSolver::periodCycles(static_cast<byte>(Steps - 1u), ClockSelect - 1u);
+} /* getSampleRate */
+
+
+/******************************************************************************************************************************************************
+  getStatistics()
+******************************************************************************************************************************************************/
+/*! \brief          get the statistics of the interrupt
+ *  \details        the counters are updated by the prefetch of each block, they are kept until resetStatistics() or begin().
+ *
+ *  \return         statistics of the interrupt
+ *****************************************************************************************************************************************************/
+TimerTwoPcm::StatisticsType TimerTwoPcm::getStatistics()
+{
+    StatisticsType sStatistics;
+    uint8_t SregSave = SREG;
+    cli();
+    sStatistics.Samples = Statistics.Samples;
+    sStatistics.BusyCounts = Statistics.BusyCounts;
+    sStatistics.Underruns = Statistics.Underruns;
+    SREG = SregSave;
+    return sStatistics;
+} /* getStatistics */
+
+
+/******************************************************************************************************************************************************
+  getLoad()
+******************************************************************************************************************************************************/
+/*! \brief          get the CPU share of the interrupt since the last reset of the statistics
+ *  \details        the busy time of a sample interrupt is the counter position at its end, so it includes the interrupt
+ *                  latency, but not the epilogue of the interrupt (about 20 cycles). It is sampled once per block at the
+ *                  block switch. The prefetch adds the timer counts from its start to its end, also across TOP, without
+ *                  the sample interrupts which preempted it. The resolution is one timer count, it is averaged over all
+ *                  samples.
+ *
+ *  \return         CPU share in per mille, 0 without samples
+ *****************************************************************************************************************************************************/
+uint16_t TimerTwoPcm::getLoad()
+{
+    StatisticsType sStatistics = getStatistics();
+    if(0u == sStatistics.Samples) { return 0u; }
+    return static_cast<uint16_t>((static_cast<uint64_t>(sStatistics.BusyCounts) * 1000u) / (static_cast<uint64_t>(sStatistics.Samples) * Steps));
+} /* getLoad */
+
+
+/******************************************************************************************************************************************************
+  resetStatistics()
+******************************************************************************************************************************************************/
+/*! \brief          clear the statistics of the interrupt
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoPcm::resetStatistics()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Statistics.Samples = 0u;
+    Statistics.BusyCounts = 0u;
+    Statistics.Underruns = 0u;
+    SREG = SregSave;
+} /* resetStatistics */
+
+
+/******************************************************************************************************************************************************
+  begin()
+******************************************************************************************************************************************************/
+/*! \brief          start the PCM output on pin 3 with silence
+ *  \details        the smallest prescaler with TOP up to 0xFF is taken, samples are scaled to TOP + 1 PWM steps. At 16 MHz
+ *                  8 kHz has 250 steps, 16 kHz 125 steps and 22.05 kHz 91 steps. The ring buffer is cleared.
+ *
+ *  \param[in]      SampleRate              sample rate in Hertz, up to F_CPU / TIMERTWOPCM_MIN_SAMPLE_CYCLES
+ *  \return         E_OK
+ *                  E_NOT_OK - already running or sample rate out of range
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoPcm::begin(uint32_t SampleRate)
+{
+    if(Running || (0u == SampleRate)) { return E_NOT_OK; }
+
+    uint32_t Cycles = (F_CPU + (SampleRate / 2u)) / SampleRate;
+    if(Cycles < TIMERTWOPCM_MIN_SAMPLE_CYCLES) { return E_NOT_OK; }
+    byte Index = 0u;
+    uint32_t sSteps = TimerTwoPeriodSolver::steps(Cycles, Index);
+    while(sSteps > TIMERTWO_RESOLUTION) {
+        if(++Index >= TimerTwoPeriodSolver::NUMBER_OF_PRESCALERS) { return E_NOT_OK; }
+        sSteps = TimerTwoPeriodSolver::steps(Cycles, Index);
+    }
+
+    pinMode(TIMERTWO_B_ARDUINO_PIN, OUTPUT);
+
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Timsk2::write(0u);
+    Reg::Tccr2a::write<Reg::Wgm2a::Value<(TimerTwo::WaveformPolicy::WGM & Reg::Wgm2a::MAX)>, Reg::Com2b::Value<Reg::COM_NON_INVERTING> >();
+    Reg::Tccr2b::write<Reg::Wgm2b::Value<(TimerTwo::WaveformPolicy::WGM >> 2u)>, Reg::Cs2::Value<TimerTwo::REG_CS_NO_CLOCK> >();
+    TCNT2 = 0u;
+    Steps = static_cast<uint16_t>(sSteps);
+    ClockSelect = Index + 1u;
+    OCR2A = static_cast<byte>(Steps - 1u);
+    Source = SOURCE_NONE;
+    RingHead = 0u;
+    RingTail = 0u;
+    fillBlock(0u);
+    fillBlock(1u);
+    ActiveBlock = 0u;
+    NextSample = Blocks[0u];
+    BlockEnd = NextSample + BlockLength[0u];
+    OCR2B = scaleSample(TIMERTWOPCM_IDLE_SAMPLE);
+    resetStatistics();
+    Reg::Tifr2::write<Reg::Tov2::Value<1u>, Reg::Ocf2a::Value<1u>, Reg::Ocf2b::Value<1u> >();
+    Reg::Toie2::write<1u>();
+    Reg::Cs2::write(ClockSelect);
+    Running = true;
+    SREG = SregSave;
+    return E_OK;
+} /* begin */
+
+
+/******************************************************************************************************************************************************
+  end()
+******************************************************************************************************************************************************/
+/*! \brief          stop Timer2 and the PCM output, pin 3 is cleared
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoPcm::end()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Timsk2::write(0u);
+    Reg::Cs2::write<TimerTwo::REG_CS_NO_CLOCK>();
+    Reg::Com2b::write<0u>();
+    Source = SOURCE_NONE;
+    Running = false;
+    SREG = SregSave;
+    digitalWrite(TIMERTWO_B_ARDUINO_PIN, LOW);
+} /* end */
+
+
+/******************************************************************************************************************************************************
+  play()
+******************************************************************************************************************************************************/
+/*! \brief          play samples from program memory, replaces the current source
+ *  \details        isPlaying() turns false when the last samples are prefetched, up to two blocks before they are output.
+ *
+ *  \param[in]      Samples                 unsigned 8 bit samples in program memory
+ *  \param[in]      Length                  number of samples
+ *  \return         E_OK
+ *                  E_NOT_OK - not running or no samples given
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoPcm::play(const byte* Samples, uint16_t Length)
+{
+    if(!Running || (nullptr == Samples) || (0u == Length)) { return E_NOT_OK; }
+
+    uint8_t SregSave = SREG;
+    cli();
+    ProgmemSamples = Samples;
+    ProgmemRemaining = Length;
+    Source = SOURCE_PROGMEM;
+    SREG = SregSave;
+    return E_OK;
+} /* play */
+
+
+/******************************************************************************************************************************************************
+  startStream()
+******************************************************************************************************************************************************/
+/*! \brief          play the samples of the ring buffer, replaces the current source
+ *  \details        samples which were written before are kept, so the ring can be filled before the start to avoid
+ *                  underruns. Every sample the ring is empty for outputs silence and counts as underrun.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - not running
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoPcm::startStream()
+{
+    if(!Running) { return E_NOT_OK; }
+    /* a single byte, written atomically */
+    Source = SOURCE_STREAM;
+    return E_OK;
+} /* startStream */
+
+
+/******************************************************************************************************************************************************
+  stop()
+******************************************************************************************************************************************************/
+/*! \brief          stop the playback and clear the ring buffer, the prefetched blocks are played to the end
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoPcm::stop()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Source = SOURCE_NONE;
+    RingTail = RingHead;
+    SREG = SregSave;
+} /* stop */
+
+
+/******************************************************************************************************************************************************
+  write()
+******************************************************************************************************************************************************/
+/*! \brief          append a sample to the ring buffer, called from main context only
+ *  \details        the ring has a single producer and a single consumer, the interrupt. The sample is written before the
+ *                  head index, so no atomic section is needed.
+ *
+ *  \param[in]      Sample                  unsigned 8 bit sample
+ *  \return         E_OK
+ *                  E_NOT_OK - ring buffer full
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoPcm::write(byte Sample)
+{
+    byte Head = RingHead;
+    if(static_cast<byte>(Head - RingTail) >= TIMERTWO_PCM_RING_SIZE) { return E_NOT_OK; }
+
+    Ring[Head & (TIMERTWO_PCM_RING_SIZE - 1u)] = Sample;
+    TIMERTWO_MEMORY_BARRIER();
+    RingHead = Head + 1u;
+    return E_OK;
+} /* write */
+
+
+/******************************************************************************************************************************************************
+  write()
+******************************************************************************************************************************************************/
+/*! \brief          append samples to the ring buffer, called from main context only
+ *
+ *  \param[in]      Samples                 unsigned 8 bit samples
+ *  \param[in]      Length                  number of samples
+ *  \return         number of samples written, less than Length if the ring buffer is full
+ *****************************************************************************************************************************************************/
+byte TimerTwoPcm::write(const byte* Samples, byte Length)
+{
+    byte Head = RingHead;
+    byte Free = TIMERTWO_PCM_RING_SIZE - static_cast<byte>(Head - RingTail);
+    if(Length > Free) { Length = Free; }
+
+    for(byte Index = 0u; Index < Length; Index++) { Ring[(Head + Index) & (TIMERTWO_PCM_RING_SIZE - 1u)] = Samples[Index]; }
+    TIMERTWO_MEMORY_BARRIER();
+    RingHead = Head + Length;
+    return Length;
+} /* write */
+
+
+/******************************************************************************************************************************************************
+  prefetchBlock()
+******************************************************************************************************************************************************/
+/*! \brief          refill the played block, the tail of the block switch in the compare match A interrupt
+ *  \details        the interrupt disables itself and enables the global interrupts, so the sample interrupt preempts the
+ *                  prefetch, which only has to end within the other block. The statistics of the played block are its
+ *                  samples times the busy counts of the switching sample interrupt plus the counts of the prefetch. Each
+ *                  BOTTOM the prefetch ran past was served by a preempting sample interrupt or is still pending, it adds
+ *                  one sample period, the preempting interrupts are already counted with the samples.
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoPcm::prefetchBlock()
+{
+    byte StartCount = TCNT2;
+    Reg::Ocie2a::write<0u>();
+    byte Played = ActiveBlock ^ 1u;
+    byte Length = BlockLength[Played];
+    const byte* FirstSample = NextSample;
+    sei();
+    fillBlock(Played);
+    cli();
+
+    /* the counter is read before the flag, a BOTTOM after the read does not count */
+    byte EndCount = TCNT2;
+    byte Preempted = static_cast<byte>(NextSample - FirstSample);
+    uint16_t Bottoms = Preempted;
+    if(Reg::Tifr2::readBit<TOV2>() && (EndCount < (Steps >> 1u))) { Bottoms++; }
+    uint32_t PrefetchCounts = EndCount - StartCount;
+    if(Bottoms != 0u) { PrefetchCounts = (Steps - StartCount) + EndCount + (static_cast<uint32_t>(Bottoms - 1u) * Steps) - (Preempted * SampleBusyCounts); }
+    Statistics.Samples = Statistics.Samples + Length;
+    Statistics.BusyCounts = Statistics.BusyCounts + (static_cast<uint16_t>(Length) * SampleBusyCounts) + PrefetchCounts;
+} /* prefetchBlock */
+
+
+/******************************************************************************************************************************************************
+ * P R I V A T E   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  fillBlock()
+******************************************************************************************************************************************************/
+/*! \brief          prefetch the next block from the source and scale it to TOP
+ *  \details        without a source the block is a full block of silence. An empty ring gives a block of a single silent
+ *                  sample, so the stream continues one sample after new data is written.
+ *
+ *  \param[in]      Block                   index of the block to fill
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoPcm::fillBlock(byte Block)
+{
+    byte* Samples = Blocks[Block];
+    byte Length = 0u;
+
+    if(SOURCE_PROGMEM == Source) {
+        Length = (ProgmemRemaining > TIMERTWO_PCM_BLOCK_SIZE) ? TIMERTWO_PCM_BLOCK_SIZE : static_cast<byte>(ProgmemRemaining);
+        const byte* Progmem = ProgmemSamples;
+        for(byte Index = 0u; Index < Length; Index++) { Samples[Index] = scaleSample(pgm_read_byte(Progmem++)); }
+        ProgmemSamples = Progmem;
+        ProgmemRemaining -= Length;
+        if(0u == ProgmemRemaining) { Source = SOURCE_NONE; }
+    } else if(SOURCE_STREAM == Source) {
+        byte Tail = RingTail;
+        byte Count = RingHead - Tail;
+        Length = (Count > TIMERTWO_PCM_BLOCK_SIZE) ? TIMERTWO_PCM_BLOCK_SIZE : Count;
+        for(byte Index = 0u; Index < Length; Index++) { Samples[Index] = scaleSample(Ring[Tail++ & (TIMERTWO_PCM_RING_SIZE - 1u)]); }
+        TIMERTWO_MEMORY_BARRIER();
+        RingTail = Tail;
+        if((0u == Length) && (Statistics.Underruns != UINT16_MAX)) { Statistics.Underruns = Statistics.Underruns + 1u; }
+    }
+
+    if(0u == Length) {
+        Length = (SOURCE_STREAM == Source) ? 1u : TIMERTWO_PCM_BLOCK_SIZE;
+        byte Silence = scaleSample(TIMERTWOPCM_IDLE_SAMPLE);
+        for(byte Index = 0u; Index < Length; Index++) { Samples[Index] = Silence; }
+    }
+    BlockLength[Block] = Length;
+} /* fillBlock */
+
+
+/******************************************************************************************************************************************************
+ * I N T E R R U P T   S E R V I C E   R O U T I N E
+ *****************************************************************************************************************************************************/
+/* replaces the weak tick interrupt of TimerTwo.cpp */
+ISR(TIMER2_OVF_vect)
+{
+    Timer2Pcm.updateSample();
+}
+
+ISR(TIMER2_COMPA_vect)
+{
+    Timer2Pcm.prefetchBlock();
+}
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
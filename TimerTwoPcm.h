@@ -0,0 +1,171 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoPcm.h
+ *      \brief      Header file of the TimerTwo PCM sample player
+ *
+ *      \details    Playback of unsigned 8 bit samples on pin 3 (OC2B). Timer2 runs in Fast PWM mode with TOP OCR2A, one
+ *                  PWM period is one sample. The samples are read from program memory or from a ring buffer, which is
+ *                  filled by the application, e. g. from Serial. They are prefetched and scaled to TOP in blocks, so the
+ *                  overflow interrupt only loads the next sample and stores it to OCR2B. The refill of a played block runs
+ *                  in the compare match A interrupt, which the sample interrupt can preempt.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOPCM_H_
+#define _TIMERTWOPCM_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+
+#if TIMERTWO_PCM
+
+#if (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_FAST_PWM)
+# error "TimerTwo: the PCM player needs TIMERTWO_MODE_FAST_PWM, the sample rate is set by OCR2A"
+#endif
+#if (TIMERTWO_PCM_BLOCK_SIZE < 2u) || (TIMERTWO_PCM_BLOCK_SIZE > 64u)
+# error "TimerTwo: TIMERTWO_PCM_BLOCK_SIZE has to be 2 to 64"
+#endif
+#if (TIMERTWO_PCM_RING_SIZE == 0u) || (TIMERTWO_PCM_RING_SIZE > 128u) || ((TIMERTWO_PCM_RING_SIZE & (TIMERTWO_PCM_RING_SIZE - 1u)) != 0u)
+# error "TimerTwo: TIMERTWO_PCM_RING_SIZE has to be a power of two, at most 128"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* shortest sample period in CPU cycles (31.25 kHz at 16 MHz), the prefetch of a block has to end within the other block */
+#ifndef TIMERTWOPCM_MIN_SAMPLE_CYCLES
+# define TIMERTWOPCM_MIN_SAMPLE_CYCLES              512u
+#endif
+/* CPU cycles of the prefetch per sample: load, scale to TOP and store */
+#define TIMERTWOPCM_PREFETCH_CYCLES_PER_SAMPLE      14u
+/* CPU cycles of the sample interrupt including interrupt response and register saving, it preempts the prefetch */
+#define TIMERTWOPCM_SAMPLE_CYCLES                   40u
+/* sample of silence, the middle of the 8 bit range */
+#define TIMERTWOPCM_IDLE_SAMPLE                     128u
+
+#if ((TIMERTWOPCM_PREFETCH_CYCLES_PER_SAMPLE + TIMERTWOPCM_SAMPLE_CYCLES) >= TIMERTWOPCM_MIN_SAMPLE_CYCLES)
+# error "TimerTwo: the prefetch of a block does not end within the other block, raise TIMERTWOPCM_MIN_SAMPLE_CYCLES"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoPcm
+ *****************************************************************************************************************************************************/
+class TimerTwoPcm
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    enum SourceType {
+        SOURCE_NONE = 0,
+        SOURCE_PROGMEM,
+        SOURCE_STREAM
+    };
+
+    /* Samples counts the interrupts, BusyCounts the timer counts from the overflow to the end of each interrupt plus the
+       counts of the prefetch and Underruns the samples the stream had no data for, Underruns saturates */
+    struct StatisticsType {
+        uint32_t Samples;
+        uint32_t BusyCounts;
+        uint16_t Underruns;
+    };
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoPcm();
+    ~TimerTwoPcm();
+    TimerTwoPcm(const TimerTwoPcm&);
+
+    /* two prefetched blocks of samples scaled to TOP, the interrupt plays one and refills the other one when it
+       switches. A block of the stream is shorter if the ring has less samples */
+    byte Blocks[2][TIMERTWO_PCM_BLOCK_SIZE];
+    byte BlockLength[2];
+    byte ActiveBlock;
+    const byte* NextSample;
+    const byte* BlockEnd;
+    /* lock-free ring of the stream, RingHead is only written by write(), RingTail only by the interrupt */
+    byte Ring[TIMERTWO_PCM_RING_SIZE];
+    volatile byte RingHead;
+    volatile byte RingTail;
+    /* source of the next prefetch */
+    volatile SourceType Source;
+    const byte* ProgmemSamples;
+    uint16_t ProgmemRemaining;
+    /* PWM steps of one sample period (TOP + 1) */
+    uint16_t Steps;
+    byte ClockSelect;
+    /* counter position at the end of the sample interrupt which switched the blocks, sampled once per block */
+    byte SampleBusyCounts;
+    volatile StatisticsType Statistics;
+    bool Running;
+
+    // functions
+    byte scaleSample(byte Sample) const { return static_cast<byte>((Sample * Steps) >> 8u); }
+    void fillBlock(byte);
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoPcm& getInstance();
+
+    // get methods
+    bool isRunning() const { return Running; }
+    bool isPlaying() const { return Source != SOURCE_NONE; }
+    SourceType getSource() const { return Source; }
+    uint32_t getSampleRate() const;
+    /* PWM steps of one sample, 256 is the full 8 bit resolution */
+    uint16_t getSteps() const { return Steps; }
+    byte getFree() const { return TIMERTWO_PCM_RING_SIZE - static_cast<byte>(RingHead - RingTail); }
+    StatisticsType getStatistics();
+    uint16_t getLoad();
+    void resetStatistics();
+
+    // methods
+    StdReturnType begin(uint32_t);
+    void end();
+    StdReturnType play(const byte*, uint16_t);
+    StdReturnType startStream();
+    void stop();
+    StdReturnType write(byte);
+    byte write(const byte*, byte);
+    /* overflow interrupt: OCR2B is double buffered, the sample becomes active at the next BOTTOM without jitter. There is
+       no call, so the interrupt saves only the registers it uses. At the end of a block it continues with the other one
+       and enables the compare match A interrupt, its flag is set since TOP, so prefetchBlock() follows at once */
+    void updateSample() {
+        OCR2B = *NextSample;
+        if(++NextSample == BlockEnd) {
+            byte Active = ActiveBlock ^ 1u;
+            ActiveBlock = Active;
+            NextSample = Blocks[Active];
+            BlockEnd = NextSample + BlockLength[Active];
+            SampleBusyCounts = TCNT2;
+            TimerTwoRegisters::Ocie2a::write<1u>();
+        }
+    }
+    void prefetchBlock();
+};
+
+/* TimerTwoPcm will be pre-instantiated in TimerTwoPcm source file */
+extern TimerTwoPcm& Timer2Pcm;
+
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
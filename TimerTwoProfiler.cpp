@@ -0,0 +1,182 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoProfiler.cpp
+ *      \brief      Source file of the TimerTwo sampling profiler
+ *
+ *      \details    The histogram covers TIMERTWO_PROFILER_BINS << TIMERTWO_PROFILER_BIN_SHIFT program words from
+ *                  TIMERTWO_PROFILER_PC_START on, samples outside are only counted. The bins saturate at 0xFFFF.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOPROFILER_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoProfiler.h"
+
+#if TIMERTWO_PROFILER
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoProfiler& Timer2Profiler = TimerTwoProfiler::getInstance();    // pre-instantiate TimerTwoProfiler
+volatile uint16_t TimerTwoProfilerPc;
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoProfiler
+******************************************************************************************************************************************************/
+TimerTwoProfiler::TimerTwoProfiler()
+{
+    Running = false;
+    Divider = 1u;
+    DividerCount = 1u;
+    reset();
+} /* TimerTwoProfiler */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoProfiler
+******************************************************************************************************************************************************/
+TimerTwoProfiler::~TimerTwoProfiler()
+{
+
+} /* ~TimerTwoProfiler */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoProfiler& TimerTwoProfiler::getInstance()
+{
+    static TimerTwoProfiler SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getSamples()
+******************************************************************************************************************************************************/
+uint32_t TimerTwoProfiler::getSamples() const
+{
+    uint8_t SregSave = SREG;
+    cli();
+    uint32_t CurrentSamples = Samples;
+    SREG = SregSave;
+    return CurrentSamples;
+} /* getSamples */
+
+
+/******************************************************************************************************************************************************
+  start()
+******************************************************************************************************************************************************/
+/*! \brief          start sampling
+ *  \details        every Divider-th Timer2 tick is sampled, so the sample rate is the tick rate / Divider. The overhead
+ *                  of a sample is bounded (about 40 cycles), the overhead of a skipped tick is the stub and one decrement.
+ *
+ *  \param[in]      SampleDivider           ticks per sample (1 - 255)
+ *  \return         E_OK
+ *                  E_NOT_OK - SampleDivider is 0
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoProfiler::start(byte SampleDivider)
+{
+    if(SampleDivider != 0u) {
+        uint8_t SregSave = SREG;
+        cli();
+        Divider = SampleDivider;
+        DividerCount = SampleDivider;
+        Running = true;
+        SREG = SregSave;
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* start */
+
+
+/******************************************************************************************************************************************************
+  stop()
+******************************************************************************************************************************************************/
+void TimerTwoProfiler::stop()
+{
+    Running = false;
+} /* stop */
+
+
+/******************************************************************************************************************************************************
+  reset()
+******************************************************************************************************************************************************/
+void TimerTwoProfiler::reset()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    for(uint16_t Bin = 0u; Bin < TIMERTWO_PROFILER_BINS; Bin++) { Bins[Bin] = 0u; }
+    Samples = 0u;
+    OutsideSamples = 0u;
+    SREG = SregSave;
+} /* reset */
+
+
+/******************************************************************************************************************************************************
+  dump()
+******************************************************************************************************************************************************/
+/*! \brief          write the histogram
+ *  \details        binary format, all values little endian: "T2PF", version (1 byte), bin shift (1 byte), number of bins
+ *                  (2 bytes), first PC as word address (2 bytes), samples (4 bytes), samples outside of the bins
+ *                  (4 bytes), bins (2 bytes each). Sampling is paused while the histogram is written.
+ *
+ *  \param[in]      Output                  e. g. Serial
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoProfiler::dump(Print& Output)
+{
+    bool WasRunning = Running;
+
+    Running = false;
+    Output.write(reinterpret_cast<const uint8_t*>(TIMERTWOPROFILER_MAGIC), 4u);
+    writeValue(Output, TIMERTWOPROFILER_VERSION, 1u);
+    writeValue(Output, TIMERTWO_PROFILER_BIN_SHIFT, 1u);
+    writeValue(Output, TIMERTWO_PROFILER_BINS, 2u);
+    writeValue(Output, TIMERTWO_PROFILER_PC_START, 2u);
+    writeValue(Output, Samples, 4u);
+    writeValue(Output, OutsideSamples, 4u);
+    for(uint16_t Bin = 0u; Bin < TIMERTWO_PROFILER_BINS; Bin++) { writeValue(Output, Bins[Bin], 2u); }
+    Running = WasRunning;
+} /* dump */
+
+
+/******************************************************************************************************************************************************
+ * P R I V A T E   F U N C T I O N S
+******************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  writeValue()
+******************************************************************************************************************************************************/
+void TimerTwoProfiler::writeValue(Print& Output, uint32_t Value, byte Size)
+{
+    for(byte Index = 0u; Index < Size; Index++) {
+        Output.write(static_cast<uint8_t>(Value));
+        Value >>= 8u;
+    }
+}
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,108 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoProfiler.h
+ *      \brief      Header file of the TimerTwo sampling profiler
+ *
+ *      \details    Statistical profiler driven by the Timer2 tick. With TIMERTWO_PROFILER enabled the interrupt service
+ *                  routine of the library takes the address of the interrupted instruction from the stack and counts it
+ *                  in a PC histogram. dump() writes the histogram in a binary format, Profiler/timertwo_profile.py maps
+ *                  the bins to the symbols of the ELF file.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOPROFILER_H_
+#define _TIMERTWOPROFILER_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+
+#if TIMERTWO_PROFILER
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* dump format: magic, version, bin shift, number of bins, first PC, samples, samples outside of the bins, bins */
+#define TIMERTWOPROFILER_MAGIC                      "T2PF"
+#define TIMERTWOPROFILER_VERSION                    1u
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL DATA
+ *****************************************************************************************************************************************************/
+/* word address of the interrupted instruction, written by the naked interrupt stub of the library, on the host by the
+   application */
+extern "C" volatile uint16_t TimerTwoProfilerPc;
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoProfiler
+ *****************************************************************************************************************************************************/
+class TimerTwoProfiler
+{
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoProfiler();
+    ~TimerTwoProfiler();
+    TimerTwoProfiler(const TimerTwoProfiler&);
+
+    /* bin i counts the PCs TIMERTWO_PROFILER_PC_START + (i << TIMERTWO_PROFILER_BIN_SHIFT) and the following */
+    uint16_t Bins[TIMERTWO_PROFILER_BINS];
+    uint32_t Samples;
+    uint32_t OutsideSamples;
+    bool Running;
+    byte Divider;
+    byte DividerCount;
+
+    // methods
+    void writeValue(Print&, uint32_t, byte);
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoProfiler& getInstance();
+
+    // get methods
+    uint32_t getSamples() const;
+    bool isRunning() const { return Running; }
+
+    // methods
+    StdReturnType start(byte = 1u);
+    void stop();
+    void reset();
+    void dump(Print&);
+    /* called by the timer interrupt with interrupts disabled, only every Divider-th tick is sampled */
+    void sample(uint16_t Pc) {
+        if(!Running) { return; }
+        if(--DividerCount != 0u) { return; }
+        DividerCount = Divider;
+        Samples++;
+        /* a PC below the first bin wraps around to a bin above the last one */
+        uint16_t Bin = static_cast<uint16_t>(Pc - TIMERTWO_PROFILER_PC_START) >> TIMERTWO_PROFILER_BIN_SHIFT;
+        if(Bin >= TIMERTWO_PROFILER_BINS) { OutsideSamples++; return; }
+        if(Bins[Bin] != UINT16_MAX) { Bins[Bin]++; }
+    }
+};
+
+/* TimerTwoProfiler will be pre-instantiated in TimerTwoProfiler source file */
+extern TimerTwoProfiler& Timer2Profiler;
+
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,181 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoRegister.h
+ *      \brief      Typed register access of TimerTwo library
+ *
+ *      \details    Registers and bit fields are types with the address, position and width as template parameters, so
+ *                  every mask and shift is a compile time constant. Several field values of one register are merged into
+ *                  one read-modify-write, or into one store if they cover the whole register. A single bit is set or
+ *                  cleared with |= or &= of a constant, which avr-gcc compiles to sbi or cbi if the register is in the
+ *                  lower I/O space. Field values which do not fit into the field are rejected by static_assert.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWO_REGISTER_H_
+#define _TIMERTWO_REGISTER_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoHal.h"
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* registers with data memory address 0x20 to 0x3F are accessible by sbi, cbi, sbis and sbic */
+#define TIMERTWO_REGISTER_BIT_ACCESS_START          0x20u
+#define TIMERTWO_REGISTER_BIT_ACCESS_END            0x40u
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoRegister
+ *****************************************************************************************************************************************************/
+/*! \brief          8 bit register at a data memory address known at compile time
+ *  \details        write<Values...>() stores the given field values in one access, bits of other fields are zero.
+ *                  modify<Values...>() keeps the other bits, it needs no read if all given values are zero or all ones.
+ *****************************************************************************************************************************************************/
+template<uint8_t Address>
+class TimerTwoRegister
+{
+  public:
+    static constexpr uint8_t ADDRESS = Address;
+    static constexpr bool BIT_ACCESS = (Address >= TIMERTWO_REGISTER_BIT_ACCESS_START) && (Address < TIMERTWO_REGISTER_BIT_ACCESS_END);
+
+    static uint8_t read() { return _SFR_MEM8(Address); }
+    static void write(uint8_t Value) { _SFR_MEM8(Address) = Value; }
+    static void modify(uint8_t Mask, uint8_t Value) { _SFR_MEM8(Address) = (_SFR_MEM8(Address) & ~Mask) | (Value & Mask); }
+
+    template<uint8_t Bit> static bool readBit() { return (_SFR_MEM8(Address) & (1u << Bit)) != 0u; }
+    template<typename... Values> static void write();
+    template<typename... Values> static void modify();
+};
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoField
+ *****************************************************************************************************************************************************/
+/*! \brief          bit field of a TimerTwoRegister
+ *  \details        Value<N> is the field value N, it can be passed to write<>() and modify<>() of the register.
+ *****************************************************************************************************************************************************/
+template<typename Register, uint8_t Position, uint8_t Width = 1u>
+class TimerTwoField
+{
+    static_assert((Width > 0u) && ((Position + Width) <= 8u), "bit field exceeds the register");
+
+  public:
+    typedef Register RegisterType;
+    static constexpr uint8_t MASK = static_cast<uint8_t>(((1u << Width) - 1u) << Position);
+    static constexpr uint8_t MAX = static_cast<uint8_t>((1u << Width) - 1u);
+
+    template<uint8_t sValue>
+    struct Value
+    {
+        static_assert(sValue <= MAX, "value does not fit into the bit field");
+        typedef Register RegisterType;
+        static constexpr uint8_t MASK = TimerTwoField::MASK;
+        static constexpr uint8_t BITS = static_cast<uint8_t>(sValue << Position);
+    };
+
+    static uint8_t read() { return (Register::read() & MASK) >> Position; }
+    /* value known at run time only, bits beyond the field are ignored */
+    static void write(uint8_t sValue) { Register::modify(MASK, static_cast<uint8_t>(sValue << Position)); }
+    template<uint8_t sValue> static void write() { Register::template modify<Value<sValue> >(); }
+};
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoFieldSet
+ *****************************************************************************************************************************************************/
+/*! \brief          merges field values of one register into one mask and one value at compile time
+ *****************************************************************************************************************************************************/
+template<typename... Values>
+struct TimerTwoFieldSet
+{
+    static constexpr uint8_t MASK = 0u;
+    static constexpr uint8_t BITS = 0u;
+    template<uint8_t Address> static constexpr bool isOf() { return true; }
+};
+
+template<typename First, typename... Rest>
+struct TimerTwoFieldSet<First, Rest...>
+{
+    static_assert((First::MASK & TimerTwoFieldSet<Rest...>::MASK) == 0u, "bit field is given twice");
+    static constexpr uint8_t MASK = First::MASK | TimerTwoFieldSet<Rest...>::MASK;
+    static constexpr uint8_t BITS = First::BITS | TimerTwoFieldSet<Rest...>::BITS;
+    template<uint8_t Address> static constexpr bool isOf() {
+        return (First::RegisterType::ADDRESS == Address) && TimerTwoFieldSet<Rest...>::template isOf<Address>();
+    }
+};
+
+
+/******************************************************************************************************************************************************
+ *  TimerTwoRegister functions
+ *****************************************************************************************************************************************************/
+template<uint8_t Address>
+template<typename... Values>
+inline void TimerTwoRegister<Address>::write()
+{
+    typedef TimerTwoFieldSet<Values...> Set;
+    static_assert(Set::template isOf<Address>(), "bit field of another register");
+
+    _SFR_MEM8(Address) = Set::BITS;
+}
+
+template<uint8_t Address>
+template<typename... Values>
+inline void TimerTwoRegister<Address>::modify()
+{
+    typedef TimerTwoFieldSet<Values...> Set;
+    static_assert(Set::template isOf<Address>(), "bit field of another register");
+
+    /* all conditions are constant, only one branch is compiled */
+    if(Set::MASK == 0xFFu) { _SFR_MEM8(Address) = Set::BITS; }
+    else if(Set::BITS == 0u) { _SFR_MEM8(Address) &= static_cast<uint8_t>(~Set::MASK); }
+    else if(Set::BITS == Set::MASK) { _SFR_MEM8(Address) |= Set::MASK; }
+    else { _SFR_MEM8(Address) = (_SFR_MEM8(Address) & static_cast<uint8_t>(~Set::MASK)) | Set::BITS; }
+}
+
+
+/******************************************************************************************************************************************************
+ *  Timer/Counter2 registers, bit fields and output ports
+ *****************************************************************************************************************************************************/
+struct TimerTwoRegisters
+{
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_TIFR2> Tifr2;
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_TIMSK2> Timsk2;
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_TCCR2A> Tccr2a;
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_TCCR2B> Tccr2b;
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_PORTB> Portb;
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_PORTC> Portc;
+    typedef TimerTwoRegister<TIMERTWO_ADDRESS_PORTD> Portd;
+
+    typedef TimerTwoField<Tifr2, TOV2> Tov2;
+    typedef TimerTwoField<Tifr2, OCF2A> Ocf2a;
+    typedef TimerTwoField<Tifr2, OCF2B> Ocf2b;
+    typedef TimerTwoField<Timsk2, TOIE2> Toie2;
+    typedef TimerTwoField<Timsk2, OCIE2A> Ocie2a;
+    typedef TimerTwoField<Timsk2, OCIE2B> Ocie2b;
+    /* WGM21:0, WGM22 is in TCCR2B */
+    typedef TimerTwoField<Tccr2a, WGM20, 2u> Wgm2a;
+    typedef TimerTwoField<Tccr2a, COM2B0, 2u> Com2b;
+    typedef TimerTwoField<Tccr2a, COM2A0, 2u> Com2a;
+    typedef TimerTwoField<Tccr2b, CS20, 3u> Cs2;
+    typedef TimerTwoField<Tccr2b, WGM22> Wgm2b;
+
+    /* compare output mode of the PWM modes: clear on compare match */
+    static constexpr uint8_t COM_NON_INVERTING = 2u;
+};
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,407 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoSoftPwm.cpp
+ *      \brief      Source file of the TimerTwo software PWM
+ *
+ *      \details    The duty cycle of a channel is Duty / 256 of the Timer2 period, 0 is always off and 255 always on.
+ *                  The interrupt load is one interrupt at BOTTOM plus one per distinct edge, see README.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOSOFTPWM_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoSoftPwm.h"
+
+#if TIMERTWO_SOFTPWM_CHANNELS
+
+/******************************************************************************************************************************************************
+ *  LOCAL DATA TYPES AND STRUCTURES
+ *****************************************************************************************************************************************************/
+typedef TimerTwoRegisters Reg;
+
+/* prescaler as power of two, indexed by the clock select bit group */
+static const byte PrescalerShift[8] = { 0u, 0u, 3u, 5u, 6u, 7u, 8u, 10u };
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoSoftPwm& Timer2SoftPwm = TimerTwoSoftPwm::getInstance();      // pre-instantiate TimerTwoSoftPwm
+
+
+/******************************************************************************************************************************************************
+ * LOCAL FUNCTIONS
+ *****************************************************************************************************************************************************/
+/* port index 0 is PORTB, 1 is PORTC and 2 is PORTD */
+static inline void clearPins(const byte* KeepMask)
+{
+    Reg::Portb::write(Reg::Portb::read() & KeepMask[0u]);
+    Reg::Portc::write(Reg::Portc::read() & KeepMask[1u]);
+    Reg::Portd::write(Reg::Portd::read() & KeepMask[2u]);
+}
+
+static inline void writePins(const byte* KeepMask, const byte* SetMask)
+{
+    Reg::Portb::write((Reg::Portb::read() & KeepMask[0u]) | SetMask[0u]);
+    Reg::Portc::write((Reg::Portc::read() & KeepMask[1u]) | SetMask[1u]);
+    Reg::Portd::write((Reg::Portd::read() & KeepMask[2u]) | SetMask[2u]);
+}
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoSoftPwm
+******************************************************************************************************************************************************/
+TimerTwoSoftPwm::TimerTwoSoftPwm()
+{
+    for(byte Channel = 0u; Channel < TIMERTWO_SOFTPWM_CHANNELS; Channel++) {
+        Pins[Channel] = TIMERTWOSOFTPWM_NO_PIN;
+        Duty[Channel] = 0u;
+    }
+    for(byte Port = 0u; Port < TIMERTWOSOFTPWM_NUMBER_OF_PORTS; Port++) {
+        ReleaseMask[Port] = 0u;
+        ScheduledReleaseMask[Port] = 0u;
+    }
+    ActiveSchedule = 0u;
+    UpdatePending = false;
+    NextEdge = 0u;
+    Running = false;
+} /* TimerTwoSoftPwm */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoSoftPwm
+******************************************************************************************************************************************************/
+TimerTwoSoftPwm::~TimerTwoSoftPwm()
+{
+
+} /* ~TimerTwoSoftPwm */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoSoftPwm& TimerTwoSoftPwm::getInstance()
+{
+    static TimerTwoSoftPwm SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  getDuty()
+******************************************************************************************************************************************************/
+/*! \brief          get the staged duty cycle of a pin
+ *
+ *  \param[in]      Pin                     Arduino pin
+ *  \return         duty cycle, 0 if the pin is not attached
+ *****************************************************************************************************************************************************/
+byte TimerTwoSoftPwm::getDuty(byte Pin) const
+{
+    byte Channel = findChannel(Pin);
+    return (Channel < TIMERTWO_SOFTPWM_CHANNELS) ? Duty[Channel] : 0u;
+} /* getDuty */
+
+
+/******************************************************************************************************************************************************
+  begin()
+******************************************************************************************************************************************************/
+/*! \brief          start the software PWM
+ *  \details        the PWM period is the hardware period of Timer2 (TOP + 1 timer counts), so Timer2 has to be initialized
+ *                  with a period up to getPeriodMax(). The compare match B interrupt is enabled, all attached pins are
+ *                  set at the next BOTTOM. After a change of the period commitUpdate() has to be called again.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - already running or the period of Timer2 is too short for the prescaler
+ *  \pre            Timer2 is initialized
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoSoftPwm::begin()
+{
+    StdReturnType ReturnValue = E_NOT_OK;
+
+    uint8_t SregSave = SREG;
+    cli();
+    if(!Running && (buildSchedule(Schedules[ActiveSchedule]) == E_OK)) {
+        ReturnValue = E_OK;
+        /* the pins are cleared by end() and detach(), nothing to release */
+        for(byte Port = 0u; Port < TIMERTWOSOFTPWM_NUMBER_OF_PORTS; Port++) { ReleaseMask[Port] = 0u; }
+        UpdatePending = false;
+        NextEdge = 0u;
+        OCR2B = 0u;
+        Reg::Tifr2::write<Reg::Ocf2b::Value<1u> >();
+        Reg::Ocie2b::write<1u>();
+        Running = true;
+    }
+    SREG = SregSave;
+    return ReturnValue;
+} /* begin */
+
+
+/******************************************************************************************************************************************************
+  end()
+******************************************************************************************************************************************************/
+/*! \brief          stop the software PWM, all attached pins are cleared
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoSoftPwm::end()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    Reg::Ocie2b::write<0u>();
+    Running = false;
+    UpdatePending = false;
+    SREG = SregSave;
+    for(byte Channel = 0u; Channel < TIMERTWO_SOFTPWM_CHANNELS; Channel++) {
+        if(Pins[Channel] != TIMERTWOSOFTPWM_NO_PIN) { digitalWrite(Pins[Channel], LOW); }
+    }
+} /* end */
+
+
+/******************************************************************************************************************************************************
+  attach()
+******************************************************************************************************************************************************/
+/*! \brief          add a channel
+ *  \details        the pin is configured as output and cleared. If the software PWM is running, the channel starts with
+ *                  the next period.
+ *
+ *  \param[in]      Pin                     Arduino pin of PORTB, PORTC or PORTD
+ *  \param[in]      sDuty                   duty cycle, 0 always off, 255 always on
+ *  \return         E_OK
+ *                  E_NOT_OK - invalid pin, pin already attached or all channels in use
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoSoftPwm::attach(byte Pin, byte sDuty)
+{
+    byte Port = digitalPinToPort(Pin);
+
+    if((Port < PB) || (Port > PD) || (findChannel(Pin) < TIMERTWO_SOFTPWM_CHANNELS)) { return E_NOT_OK; }
+    byte Channel = findChannel(TIMERTWOSOFTPWM_NO_PIN);
+    if(Channel >= TIMERTWO_SOFTPWM_CHANNELS) { return E_NOT_OK; }
+
+    pinMode(Pin, OUTPUT);
+    digitalWrite(Pin, LOW);
+    ReleaseMask[Port - PB] &= ~digitalPinToBitMask(Pin);
+    Pins[Channel] = Pin;
+    Duty[Channel] = sDuty;
+    return Running ? commitUpdate() : E_OK;
+} /* attach */
+
+
+/******************************************************************************************************************************************************
+  detach()
+******************************************************************************************************************************************************/
+/*! \brief          remove a channel, the pin is cleared
+ *  \details        if the software PWM is running, the active schedule can set the pin again until the next BOTTOM,
+ *                  there the new schedule clears it. It is released for other use by the next commitUpdate() after that.
+ *
+ *  \param[in]      Pin                     Arduino pin
+ *  \return         E_OK
+ *                  E_NOT_OK - pin is not attached
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoSoftPwm::detach(byte Pin)
+{
+    byte Channel = findChannel(Pin);
+
+    if(Channel >= TIMERTWO_SOFTPWM_CHANNELS) { return E_NOT_OK; }
+    Pins[Channel] = TIMERTWOSOFTPWM_NO_PIN;
+    Duty[Channel] = 0u;
+    digitalWrite(Pin, LOW);
+    if(Running) {
+        ReleaseMask[digitalPinToPort(Pin) - PB] |= digitalPinToBitMask(Pin);
+        return commitUpdate();
+    }
+    return E_OK;
+} /* detach */
+
+
+/******************************************************************************************************************************************************
+  stageDuty()
+******************************************************************************************************************************************************/
+/*! \brief          set the duty cycle of a channel, it is applied by commitUpdate()
+ *
+ *  \param[in]      Pin                     Arduino pin
+ *  \param[in]      sDuty                   duty cycle, 0 always off, 255 always on
+ *  \return         E_OK
+ *                  E_NOT_OK - pin is not attached
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoSoftPwm::stageDuty(byte Pin, byte sDuty)
+{
+    byte Channel = findChannel(Pin);
+
+    if(Channel >= TIMERTWO_SOFTPWM_CHANNELS) { return E_NOT_OK; }
+    Duty[Channel] = sDuty;
+    return E_OK;
+} /* stageDuty */
+
+
+/******************************************************************************************************************************************************
+  commitUpdate()
+******************************************************************************************************************************************************/
+/*! \brief          apply all staged duty cycles at the beginning of the next period
+ *  \details        the schedule is built in the inactive buffer, a pending schedule which is not active yet is replaced.
+ *                  So all channels change in the same period and the interrupt does not sort.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - the period of Timer2 is too short for the prescaler
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoSoftPwm::commitUpdate()
+{
+    if(!Running) { return E_OK; }
+
+    uint8_t SregSave = SREG;
+    cli();
+    bool Applied = !UpdatePending;
+    UpdatePending = false;
+    SREG = SregSave;
+    /* the pins released by the last schedule are cleared already, if it is active */
+    for(byte Port = 0u; Port < TIMERTWOSOFTPWM_NUMBER_OF_PORTS; Port++) {
+        if(Applied) { ReleaseMask[Port] &= ~ScheduledReleaseMask[Port]; }
+        ScheduledReleaseMask[Port] = ReleaseMask[Port];
+    }
+    /* the interrupt does not touch the inactive buffer while no update is pending */
+    if(buildSchedule(Schedules[ActiveSchedule ^ 1u]) == E_NOT_OK) { return E_NOT_OK; }
+    UpdatePending = true;
+    return E_OK;
+} /* commitUpdate */
+
+
+/******************************************************************************************************************************************************
+  updateOutputs()
+******************************************************************************************************************************************************/
+/*! \brief          compare match B interrupt
+ *  \details        At BOTTOM a pending schedule becomes active and the pins are set, otherwise the pins of the edge are
+ *                  cleared. Edges which are too close for another interrupt are applied by waiting for the counter,
+ *                  then OCR2B is programmed to the next edge or to BOTTOM.
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoSoftPwm::updateOutputs()
+{
+    byte Edge = NextEdge;
+    byte Active = ActiveSchedule;
+
+    if((0u == Edge) && UpdatePending) {
+        Active ^= 1u;
+        ActiveSchedule = Active;
+        UpdatePending = false;
+    }
+    const ScheduleType& Schedule = Schedules[Active];
+    if(0u == Edge) { writePins(Schedule.KeepMask, Schedule.SetMask); }
+    else { clearPins(Schedule.Edges[Edge - 1u].KeepMask); }
+
+    /* Edge is the index of the next edge now, the edges are below TOP - GuardCounts, so the counter does not wrap around while waiting */
+    while((Edge < Schedule.NumberOfEdges) && (Schedule.Edges[Edge].Count <= (static_cast<uint16_t>(TCNT2) + Schedule.GuardCounts))) {
+        while(TCNT2 < Schedule.Edges[Edge].Count);
+        clearPins(Schedule.Edges[Edge].KeepMask);
+        Edge++;
+    }
+    if(Edge < Schedule.NumberOfEdges) {
+        OCR2B = Schedule.Edges[Edge].Count;
+        NextEdge = Edge + 1u;
+    } else {
+        OCR2B = 0u;
+        NextEdge = 0u;
+    }
+} /* updateOutputs */
+
+
+/******************************************************************************************************************************************************
+ * P R I V A T E   F U N C T I O N S
+******************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  findChannel()
+******************************************************************************************************************************************************/
+/*! \brief          get the channel of a pin
+ *  \return         channel, TIMERTWO_SOFTPWM_CHANNELS if the pin is not attached
+ *****************************************************************************************************************************************************/
+byte TimerTwoSoftPwm::findChannel(byte Pin) const
+{
+    byte Channel = 0u;
+    while((Channel < TIMERTWO_SOFTPWM_CHANNELS) && (Pins[Channel] != Pin)) { Channel++; }
+    return Channel;
+}
+
+/******************************************************************************************************************************************************
+  buildSchedule()
+******************************************************************************************************************************************************/
+/*! \brief          compute the sorted edges of the current duty cycles
+ *  \details        The edge of a channel is Duty * (TOP + 1) / 256 timer counts after BOTTOM, at most TOP - GuardCounts so
+ *                  the interrupt of the last edge is finished before BOTTOM. Channels with the same edge share it, their
+ *                  pins are combined in one mask per port.
+ *
+ *  \param[out]     Schedule                schedule to build
+ *  \return         E_OK
+ *                  E_NOT_OK - TOP is not greater than twice the guard counts
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoSoftPwm::buildSchedule(ScheduleType& Schedule)
+{
+    uint16_t Top = TimerTwo::WaveformPolicy::FIXED_TOP ? TimerTwoPeriodSolver::TOP_MAX : OCR2A;
+    byte GuardCounts = (TIMERTWOSOFTPWM_GUARD_CYCLES >> PrescalerShift[Reg::Cs2::read()]) + 1u;
+
+    if(Top <= (2u * GuardCounts)) { return E_NOT_OK; }
+
+    for(byte Port = 0u; Port < TIMERTWOSOFTPWM_NUMBER_OF_PORTS; Port++) {
+        Schedule.KeepMask[Port] = ~ReleaseMask[Port];
+        Schedule.SetMask[Port] = 0u;
+    }
+    Schedule.GuardCounts = GuardCounts;
+    Schedule.NumberOfEdges = 0u;
+
+    for(byte Channel = 0u; Channel < TIMERTWO_SOFTPWM_CHANNELS; Channel++) {
+        if(TIMERTWOSOFTPWM_NO_PIN == Pins[Channel]) { continue; }
+        byte Port = digitalPinToPort(Pins[Channel]) - PB;
+        byte Mask = digitalPinToBitMask(Pins[Channel]);
+        uint16_t Count = (static_cast<uint16_t>(Duty[Channel]) * (Top + 1u)) >> 8u;
+
+        Schedule.KeepMask[Port] &= ~Mask;
+        if(0u == Count) { continue; }
+        Schedule.SetMask[Port] |= Mask;
+        if(UINT8_MAX == Duty[Channel]) { continue; }
+        if(Count > (Top - GuardCounts)) { Count = Top - GuardCounts; }
+
+        /* insertion into the sorted edges, a channel with the same count is added to the edge */
+        byte Edge = 0u;
+        while((Edge < Schedule.NumberOfEdges) && (Schedule.Edges[Edge].Count < Count)) { Edge++; }
+        if((Edge == Schedule.NumberOfEdges) || (Schedule.Edges[Edge].Count != Count)) {
+            for(byte Index = Schedule.NumberOfEdges; Index > Edge; Index--) { Schedule.Edges[Index] = Schedule.Edges[Index - 1u]; }
+            Schedule.Edges[Edge].Count = Count;
+            for(byte Index = 0u; Index < TIMERTWOSOFTPWM_NUMBER_OF_PORTS; Index++) { Schedule.Edges[Edge].KeepMask[Index] = 0xFFu; }
+            Schedule.NumberOfEdges++;
+        }
+        Schedule.Edges[Edge].KeepMask[Port] &= ~Mask;
+    }
+    return E_OK;
+}
+
+
+/******************************************************************************************************************************************************
+ * I N T E R R U P T   S E R V I C E   R O U T I N E
+ *****************************************************************************************************************************************************/
+ISR(TIMER2_COMPB_vect)
+{
+    Timer2SoftPwm.updateOutputs();
+}
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,130 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoSoftPwm.h
+ *      \brief      Header file of the TimerTwo software PWM
+ *
+ *      \details    Up to TIMERTWO_SOFTPWM_CHANNELS PWM outputs on any pin of PORTB, PORTC and PORTD with the period of
+ *                  Timer2. All pins are set at BOTTOM, the pins are cleared by compare match B interrupts, OCR2B is
+ *                  programmed to the next edge. Channels with the same edge are cleared together with one mask per
+ *                  port. The edge schedule is computed by commitUpdate() in the main context and becomes active at the
+ *                  beginning of the next period.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOSOFTPWM_H_
+#define _TIMERTWOSOFTPWM_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+
+#if TIMERTWO_SOFTPWM_CHANNELS
+
+#if (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_CTC) && (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_NORMAL)
+# error "TimerTwo: software PWM needs TIMERTWO_MODE_CTC or TIMERTWO_MODE_NORMAL, OCR2B is double buffered in the PWM modes"
+#endif
+#if (TIMERTWO_SOFTPWM_CHANNELS > 24u)
+# error "TimerTwo: TIMERTWO_SOFTPWM_CHANNELS has to be at most 24"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* ports B, C and D */
+#define TIMERTWOSOFTPWM_NUMBER_OF_PORTS             3u
+#define TIMERTWOSOFTPWM_NO_PIN                      0xFFu
+/* CPU cycles from a compare match to the earliest next one the interrupt can catch, closer edges are applied by waiting */
+#define TIMERTWOSOFTPWM_GUARD_CYCLES                64u
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoSoftPwm
+ *****************************************************************************************************************************************************/
+class TimerTwoSoftPwm
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    /* pins cleared at a counter value, KeepMask is the inverted mask of the pins per port */
+    struct EdgeType {
+        byte Count;
+        byte KeepMask[TIMERTWOSOFTPWM_NUMBER_OF_PORTS];
+    };
+
+    /* one PWM period: the pins of all channels are cleared and SetMask is set at BOTTOM, then the edges follow */
+    struct ScheduleType {
+        byte KeepMask[TIMERTWOSOFTPWM_NUMBER_OF_PORTS];
+        byte SetMask[TIMERTWOSOFTPWM_NUMBER_OF_PORTS];
+        /* edges closer than GuardCounts to the current counter value are applied by waiting */
+        byte GuardCounts;
+        byte NumberOfEdges;
+        EdgeType Edges[TIMERTWO_SOFTPWM_CHANNELS];
+    };
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoSoftPwm();
+    ~TimerTwoSoftPwm();
+    TimerTwoSoftPwm(const TimerTwoSoftPwm&);
+
+    byte Pins[TIMERTWO_SOFTPWM_CHANNELS];
+    byte Duty[TIMERTWO_SOFTPWM_CHANNELS];
+    /* pins of detached channels, they are cleared at BOTTOM until a schedule without them is active */
+    byte ReleaseMask[TIMERTWOSOFTPWM_NUMBER_OF_PORTS];
+    byte ScheduledReleaseMask[TIMERTWOSOFTPWM_NUMBER_OF_PORTS];
+    /* double buffered schedule, the interrupt switches to the other one at BOTTOM if UpdatePending is set */
+    ScheduleType Schedules[2];
+    volatile byte ActiveSchedule;
+    volatile bool UpdatePending;
+    /* 0: compare match at BOTTOM is programmed, otherwise the one of Edges[NextEdge - 1] */
+    byte NextEdge;
+    bool Running;
+
+    // methods
+    byte findChannel(byte) const;
+    StdReturnType buildSchedule(ScheduleType&);
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoSoftPwm& getInstance();
+
+    // get methods
+    bool isRunning() const { return Running; }
+    bool isUpdatePending() const { return UpdatePending; }
+    byte getDuty(byte) const;
+
+    // methods
+    StdReturnType begin();
+    void end();
+    StdReturnType attach(byte, byte = 0u);
+    StdReturnType detach(byte);
+    StdReturnType stageDuty(byte, byte);
+    StdReturnType commitUpdate();
+    StdReturnType setDuty(byte Pin, byte sDuty) { return (stageDuty(Pin, sDuty) == E_OK) ? commitUpdate() : E_NOT_OK; }
+    void updateOutputs();
+};
+
+/* TimerTwoSoftPwm will be pre-instantiated in TimerTwoSoftPwm source file */
+extern TimerTwoSoftPwm& Timer2SoftPwm;
+
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,258 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoTone.cpp
+ *      \brief      Source file of the TimerTwo polyphonic tone generator
+ *
+ *      \details    The frequency of a voice is PhaseIncrement * SampleRate / 2^16, the resolution is below 1 Hz. Timer2 is
+ *                  initialized and started by the application, the tone generator only uses the compare output B.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOTONE_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoTone.h"
+
+#if TIMERTWO_TONE_VOICES
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoTone& Timer2Tone = TimerTwoTone::getInstance();      // pre-instantiate TimerTwoTone
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoTone
+******************************************************************************************************************************************************/
+TimerTwoTone::TimerTwoTone()
+{
+    for(byte Voice = 0u; Voice < TIMERTWO_TONE_VOICES; Voice++) {
+        Voices[Voice].Phase = 0u;
+        Voices[Voice].PhaseIncrement = 0u;
+        Voices[Voice].Wavetable = nullptr;
+        Voices[Voice].Duration = 0u;
+        Voices[Voice].Active = false;
+    }
+    DurationCount = DURATION_SAMPLES;
+    Running = false;
+} /* TimerTwoTone */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoTone
+******************************************************************************************************************************************************/
+TimerTwoTone::~TimerTwoTone()
+{
+
+} /* ~TimerTwoTone */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoTone& TimerTwoTone::getInstance()
+{
+    static TimerTwoTone SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  isPlaying()
+******************************************************************************************************************************************************/
+/*! \brief          find out if a voice is playing, a voice with a duration stops by itself
+ *
+ *  \param[in]      Voice                   0 to TIMERTWO_TONE_VOICES - 1
+ *  \return         true if the voice is playing
+ *****************************************************************************************************************************************************/
+bool TimerTwoTone::isPlaying(byte Voice) const
+{
+    return (Voice < TIMERTWO_TONE_VOICES) && Voices[Voice].Active;
+} /* isPlaying */
+
+
+/******************************************************************************************************************************************************
+  begin()
+******************************************************************************************************************************************************/
+/*! \brief          start the tone output on pin 3
+ *  \details        the compare output B is enabled with the idle level, samples are written from the next timer tick on.
+ *                  The sample rate is only reached if Timer2 was initialized with TimerTwo::init(Microseconds), which
+ *                  keeps the prescaler TIMERTWO_TONE_CLOCK_SELECT with this configuration.
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - already running or Timer2 is not initialized
+ *  \pre            Timer2 is initialized
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoTone::begin()
+{
+    if(Running || (Timer2.enablePwm(TimerTwo::PWM_PIN_3, TIMERTWOTONE_IDLE_SAMPLE) == E_NOT_OK)) { return E_NOT_OK; }
+
+    uint8_t SregSave = SREG;
+    cli();
+    DurationCount = DURATION_SAMPLES;
+    Running = true;
+    SREG = SregSave;
+    return E_OK;
+} /* begin */
+
+
+/******************************************************************************************************************************************************
+  end()
+******************************************************************************************************************************************************/
+/*! \brief          stop all voices and the tone output, Timer2 and its callback keep running
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoTone::end()
+{
+    noTone();
+    uint8_t SregSave = SREG;
+    cli();
+    Running = false;
+    SREG = SregSave;
+    Timer2.disablePwm(TimerTwo::PWM_PIN_3);
+} /* end */
+
+
+/******************************************************************************************************************************************************
+  play()
+******************************************************************************************************************************************************/
+/*! \brief          start a tone on a voice
+ *  \details        a voice which is playing changes its frequency and waveform without a phase jump. The duration is
+ *                  counted in the interrupt, the voice stops by itself.
+ *
+ *  \param[in]      Voice                   0 to TIMERTWO_TONE_VOICES - 1
+ *  \param[in]      Frequency               frequency in Hertz, below half the sample rate
+ *  \param[in]      Duration                duration in milliseconds, 0 plays until stop()
+ *  \param[in]      Wavetable               TIMERTWO_WAVETABLE_SIZE samples in program memory, nullptr is a square wave
+ *  \return         E_OK
+ *                  E_NOT_OK - invalid voice or frequency
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoTone::play(byte Voice, uint16_t Frequency, uint16_t Duration, const byte* Wavetable)
+{
+    if((Voice >= TIMERTWO_TONE_VOICES) || (0u == Frequency) || (Frequency >= (SAMPLE_RATE / 2u))) { return E_NOT_OK; }
+
+    uint16_t PhaseIncrement = static_cast<uint16_t>(((static_cast<uint32_t>(Frequency) << 16u) + (SAMPLE_RATE / 2u)) / SAMPLE_RATE);
+    /* one duration step takes DURATION_SAMPLES samples, a duration above 0 takes at least one step */
+    uint32_t Steps = static_cast<uint32_t>(((static_cast<uint64_t>(Duration) * SAMPLE_RATE) + (500uL * DURATION_SAMPLES)) / (1000uL * DURATION_SAMPLES));
+    if(Steps > UINT16_MAX) { Steps = UINT16_MAX; }
+    if((Duration != 0u) && (0u == Steps)) { Steps = 1u; }
+
+    uint8_t SregSave = SREG;
+    cli();
+    VoiceType& CurrentVoice = Voices[Voice];
+    if(!CurrentVoice.Active) { CurrentVoice.Phase = 0u; }
+    CurrentVoice.PhaseIncrement = PhaseIncrement;
+    CurrentVoice.Wavetable = Wavetable;
+    CurrentVoice.Duration = static_cast<uint16_t>(Steps);
+    CurrentVoice.Active = true;
+    SREG = SregSave;
+    return E_OK;
+} /* play */
+
+
+/******************************************************************************************************************************************************
+  stop()
+******************************************************************************************************************************************************/
+/*! \brief          stop a voice, it outputs the idle level
+ *
+ *  \param[in]      Voice                   0 to TIMERTWO_TONE_VOICES - 1
+ *  \return         E_OK
+ *                  E_NOT_OK - invalid voice
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoTone::stop(byte Voice)
+{
+    if(Voice >= TIMERTWO_TONE_VOICES) { return E_NOT_OK; }
+    /* a single byte, written atomically */
+    Voices[Voice].Active = false;
+    return E_OK;
+} /* stop */
+
+
+/******************************************************************************************************************************************************
+  tone()
+******************************************************************************************************************************************************/
+/*! \brief          play a square wave on the first idle voice, like the Arduino tone() without pin
+ *
+ *  \param[in]      Frequency               frequency in Hertz, below half the sample rate
+ *  \param[in]      Duration                duration in milliseconds, 0 plays until noTone()
+ *  \return         E_OK
+ *                  E_NOT_OK - all voices are playing or invalid frequency
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoTone::tone(uint16_t Frequency, uint16_t Duration)
+{
+    byte Voice = 0u;
+    while((Voice < TIMERTWO_TONE_VOICES) && Voices[Voice].Active) { Voice++; }
+    return play(Voice, Frequency, Duration);
+} /* tone */
+
+
+/******************************************************************************************************************************************************
+  noTone()
+******************************************************************************************************************************************************/
+/*! \brief          stop all voices
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoTone::noTone()
+{
+    for(byte Voice = 0u; Voice < TIMERTWO_TONE_VOICES; Voice++) { Voices[Voice].Active = false; }
+} /* noTone */
+
+
+/******************************************************************************************************************************************************
+  updateSample()
+******************************************************************************************************************************************************/
+/*! \brief          mix one sample, called by the timer tick of every hardware period
+ *  \details        OCR2B is double buffered in the PWM modes, so the sample becomes active at the next update of the
+ *                  compare register without jitter. Idle voices add the middle level, so starting and stopping a voice
+ *                  does not shift the level of the other ones.
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoTone::updateSample()
+{
+    if(!Running) { return; }
+
+    uint16_t Mix = 0u;
+    bool DurationStep = (--DurationCount == 0u);
+    if(DurationStep) { DurationCount = DURATION_SAMPLES; }
+
+    for(byte Voice = 0u; Voice < TIMERTWO_TONE_VOICES; Voice++) {
+        VoiceType& CurrentVoice = Voices[Voice];
+        if(!CurrentVoice.Active) {
+            Mix += TIMERTWOTONE_IDLE_SAMPLE;
+            continue;
+        }
+        uint16_t Phase = CurrentVoice.Phase + CurrentVoice.PhaseIncrement;
+        byte Index = Phase >> 8u;
+        CurrentVoice.Phase = Phase;
+        if(nullptr == CurrentVoice.Wavetable) { Mix += (Index & 0x80u) ? 0u : 0xFFu; }
+        else { Mix += pgm_read_byte(&CurrentVoice.Wavetable[Index]); }
+        if(DurationStep && (CurrentVoice.Duration != 0u) && (--CurrentVoice.Duration == 0u)) { CurrentVoice.Active = false; }
+    }
+    OCR2B = static_cast<byte>(Mix >> TIMERTWOTONE_MIX_SHIFT);
+} /* updateSample */
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
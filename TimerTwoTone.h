@@ -0,0 +1,125 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoTone.h
+ *      \brief      Header file of the TimerTwo polyphonic tone generator
+ *
+ *      \details    Replacement of the Arduino tone(), which takes over Timer2. Up to TIMERTWO_TONE_VOICES square wave or
+ *                  wavetable voices are mixed on pin 3 (OC2B). Every hardware period of Timer2 is one sample, the timer
+ *                  tick calls updateSample() before the postscaler, so the TimerTwo callback keeps its period.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOTONE_H_
+#define _TIMERTWOTONE_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+#include "TimerTwoWavetable.h"
+
+#if TIMERTWO_TONE_VOICES
+
+#if (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_FAST_PWM_8BIT) && (TIMERTWO_WAVEFORM_MODE != TIMERTWO_MODE_PHASE_CORRECT_8BIT)
+# error "TimerTwo: the tone generator needs TIMERTWO_MODE_FAST_PWM_8BIT or TIMERTWO_MODE_PHASE_CORRECT_8BIT, the sample rate has to be independent of OCR2A"
+#endif
+#if (TIMERTWO_TONE_VOICES != 1u) && (TIMERTWO_TONE_VOICES != 2u) && (TIMERTWO_TONE_VOICES != 4u) && (TIMERTWO_TONE_VOICES != 8u)
+# error "TimerTwo: TIMERTWO_TONE_VOICES has to be 1, 2, 4 or 8"
+#endif
+#if (TIMERTWO_TONE_CLOCK_SELECT != 1u) && (TIMERTWO_TONE_CLOCK_SELECT != 2u)
+# error "TimerTwo: TIMERTWO_TONE_CLOCK_SELECT has to be 1 or 2, lower sample rates are not usable for audio"
+#endif
+#if (TIMERTWO_TONE_VOICES == 8u) && (TIMERTWO_TONE_CLOCK_SELECT == 1u) && (TIMERTWO_WAVEFORM_MODE == TIMERTWO_MODE_FAST_PWM_8BIT)
+# error "TimerTwo: 8 voices need about 340 cycles per sample, more than the 256 cycles of TIMERTWO_MODE_FAST_PWM_8BIT with clock select 1"
+#endif
+#if TIMERTWO_DDS
+# error "TimerTwo: the tone generator and the DDS both use pin 3 and the overflow interrupt"
+#endif
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* the mix of all voices is divided by the number of voices */
+#define TIMERTWOTONE_MIX_SHIFT                      ((TIMERTWO_TONE_VOICES == 8u) ? 3u : ((TIMERTWO_TONE_VOICES == 4u) ? 2u : ((TIMERTWO_TONE_VOICES == 2u) ? 1u : 0u)))
+/* sample of an idle voice, the middle of the output range */
+#define TIMERTWOTONE_IDLE_SAMPLE                    128u
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoTone
+ *****************************************************************************************************************************************************/
+class TimerTwoTone
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    /* one sample per Timer2 period with TOP 0xFF */
+    static constexpr uint32_t SAMPLE_CYCLES = TimerTwoPeriodSolver::periodCycles(TimerTwoPeriodSolver::TOP_MAX, TIMERTWO_TONE_CLOCK_SELECT - 1u);
+    /* 78125 Hz at 20 MHz in fast PWM with clock select 1, above uint16_t */
+    static constexpr uint32_t SAMPLE_RATE = F_CPU / SAMPLE_CYCLES;
+    /* the durations are counted down every DURATION_SAMPLES samples, about once per millisecond */
+    static constexpr byte DURATION_SAMPLES = (SAMPLE_RATE + 500u) / 1000u;
+    static_assert((DURATION_SAMPLES > 0u) && (((SAMPLE_RATE + 500u) / 1000u) <= UINT8_MAX), "TimerTwoTone sample rate has to be 500 Hz to 255 kHz");
+
+    /* 16 bit phase accumulator, the upper 8 bits are the wavetable index. Wavetable nullptr is a square wave */
+    struct VoiceType {
+        uint16_t Phase;
+        uint16_t PhaseIncrement;
+        const byte* Wavetable;
+        /* remaining duration steps, 0 plays until stop() */
+        uint16_t Duration;
+        bool Active;
+    };
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoTone();
+    ~TimerTwoTone();
+    TimerTwoTone(const TimerTwoTone&);
+
+    VoiceType Voices[TIMERTWO_TONE_VOICES];
+    byte DurationCount;
+    bool Running;
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoTone& getInstance();
+
+    // get methods
+    bool isRunning() const { return Running; }
+    bool isPlaying(byte) const;
+    static uint32_t getSampleRate() { return SAMPLE_RATE; }
+
+    // methods
+    StdReturnType begin();
+    void end();
+    StdReturnType play(byte, uint16_t, uint16_t = 0u, const byte* = nullptr);
+    StdReturnType stop(byte);
+    StdReturnType tone(uint16_t, uint16_t = 0u);
+    void noTone();
+    void updateSample();
+};
+
+/* TimerTwoTone will be pre-instantiated in TimerTwoTone source file */
+extern TimerTwoTone& Timer2Tone;
+
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,90 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoWavetable.cpp
+ *      \brief      Wavetables of the TimerTwo waveform generators
+ *
+ *      \details    Tables which are not referenced are removed by the linker.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOWAVETABLE_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoWavetable.h"
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+/* 127.5 + 127.5 * sin(2 * pi * i / 256) */
+const byte TimerTwoWavetableSine[TIMERTWO_WAVETABLE_SIZE] PROGMEM = {
+    128u, 131u, 134u, 137u, 140u, 143u, 146u, 149u, 152u, 155u, 158u, 162u, 165u, 167u, 170u, 173u,
+    176u, 179u, 182u, 185u, 188u, 190u, 193u, 196u, 198u, 201u, 203u, 206u, 208u, 211u, 213u, 215u,
+    218u, 220u, 222u, 224u, 226u, 228u, 230u, 232u, 234u, 235u, 237u, 238u, 240u, 241u, 243u, 244u,
+    245u, 246u, 248u, 249u, 250u, 250u, 251u, 252u, 253u, 253u, 254u, 254u, 254u, 255u, 255u, 255u,
+    255u, 255u, 255u, 255u, 254u, 254u, 254u, 253u, 253u, 252u, 251u, 250u, 250u, 249u, 248u, 246u,
+    245u, 244u, 243u, 241u, 240u, 238u, 237u, 235u, 234u, 232u, 230u, 228u, 226u, 224u, 222u, 220u,
+    218u, 215u, 213u, 211u, 208u, 206u, 203u, 201u, 198u, 196u, 193u, 190u, 188u, 185u, 182u, 179u,
+    176u, 173u, 170u, 167u, 165u, 162u, 158u, 155u, 152u, 149u, 146u, 143u, 140u, 137u, 134u, 131u,
+    128u, 124u, 121u, 118u, 115u, 112u, 109u, 106u, 103u, 100u,  97u,  93u,  90u,  88u,  85u,  82u,
+     79u,  76u,  73u,  70u,  67u,  65u,  62u,  59u,  57u,  54u,  52u,  49u,  47u,  44u,  42u,  40u,
+     37u,  35u,  33u,  31u,  29u,  27u,  25u,  23u,  21u,  20u,  18u,  17u,  15u,  14u,  12u,  11u,
+     10u,   9u,   7u,   6u,   5u,   5u,   4u,   3u,   2u,   2u,   1u,   1u,   1u,   0u,   0u,   0u,
+      0u,   0u,   0u,   0u,   1u,   1u,   1u,   2u,   2u,   3u,   4u,   5u,   5u,   6u,   7u,   9u,
+     10u,  11u,  12u,  14u,  15u,  17u,  18u,  20u,  21u,  23u,  25u,  27u,  29u,  31u,  33u,  35u,
+     37u,  40u,  42u,  44u,  47u,  49u,  52u,  54u,  57u,  59u,  62u,  65u,  67u,  70u,  73u,  76u,
+     79u,  82u,  85u,  88u,  90u,  93u,  97u, 100u, 103u, 106u, 109u, 112u, 115u, 118u, 121u, 124u
+};
+
+const byte TimerTwoWavetableTriangle[TIMERTWO_WAVETABLE_SIZE] PROGMEM = {
+      0u,   2u,   4u,   6u,   8u,  10u,  12u,  14u,  16u,  18u,  20u,  22u,  24u,  26u,  28u,  30u,
+     32u,  34u,  36u,  38u,  40u,  42u,  44u,  46u,  48u,  50u,  52u,  54u,  56u,  58u,  60u,  62u,
+     64u,  66u,  68u,  70u,  72u,  74u,  76u,  78u,  80u,  82u,  84u,  86u,  88u,  90u,  92u,  94u,
+     96u,  98u, 100u, 102u, 104u, 106u, 108u, 110u, 112u, 114u, 116u, 118u, 120u, 122u, 124u, 126u,
+    128u, 130u, 132u, 134u, 136u, 138u, 140u, 142u, 144u, 146u, 148u, 150u, 152u, 154u, 156u, 158u,
+    160u, 162u, 164u, 166u, 168u, 170u, 172u, 174u, 176u, 178u, 180u, 182u, 184u, 186u, 188u, 190u,
+    192u, 194u, 196u, 198u, 200u, 202u, 204u, 206u, 208u, 210u, 212u, 214u, 216u, 218u, 220u, 222u,
+    224u, 226u, 228u, 230u, 232u, 234u, 236u, 238u, 240u, 242u, 244u, 246u, 248u, 250u, 252u, 254u,
+    255u, 253u, 251u, 249u, 247u, 245u, 243u, 241u, 239u, 237u, 235u, 233u, 231u, 229u, 227u, 225u,
+    223u, 221u, 219u, 217u, 215u, 213u, 211u, 209u, 207u, 205u, 203u, 201u, 199u, 197u, 195u, 193u,
+    191u, 189u, 187u, 185u, 183u, 181u, 179u, 177u, 175u, 173u, 171u, 169u, 167u, 165u, 163u, 161u,
+    159u, 157u, 155u, 153u, 151u, 149u, 147u, 145u, 143u, 141u, 139u, 137u, 135u, 133u, 131u, 129u,
+    127u, 125u, 123u, 121u, 119u, 117u, 115u, 113u, 111u, 109u, 107u, 105u, 103u, 101u,  99u,  97u,
+     95u,  93u,  91u,  89u,  87u,  85u,  83u,  81u,  79u,  77u,  75u,  73u,  71u,  69u,  67u,  65u,
+     63u,  61u,  59u,  57u,  55u,  53u,  51u,  49u,  47u,  45u,  43u,  41u,  39u,  37u,  35u,  33u,
+     31u,  29u,  27u,  25u,  23u,  21u,  19u,  17u,  15u,  13u,  11u,   9u,   7u,   5u,   3u,   1u
+};
+
+const byte TimerTwoWavetableSawtooth[TIMERTWO_WAVETABLE_SIZE] PROGMEM = {
+      0u,   1u,   2u,   3u,   4u,   5u,   6u,   7u,   8u,   9u,  10u,  11u,  12u,  13u,  14u,  15u,
+     16u,  17u,  18u,  19u,  20u,  21u,  22u,  23u,  24u,  25u,  26u,  27u,  28u,  29u,  30u,  31u,
+     32u,  33u,  34u,  35u,  36u,  37u,  38u,  39u,  40u,  41u,  42u,  43u,  44u,  45u,  46u,  47u,
+     48u,  49u,  50u,  51u,  52u,  53u,  54u,  55u,  56u,  57u,  58u,  59u,  60u,  61u,  62u,  63u,
+     64u,  65u,  66u,  67u,  68u,  69u,  70u,  71u,  72u,  73u,  74u,  75u,  76u,  77u,  78u,  79u,
+     80u,  81u,  82u,  83u,  84u,  85u,  86u,  87u,  88u,  89u,  90u,  91u,  92u,  93u,  94u,  95u,
+     96u,  97u,  98u,  99u, 100u, 101u, 102u, 103u, 104u, 105u, 106u, 107u, 108u, 109u, 110u, 111u,
+    112u, 113u, 114u, 115u, 116u, 117u, 118u, 119u, 120u, 121u, 122u, 123u, 124u, 125u, 126u, 127u,
+    128u, 129u, 130u, 131u, 132u, 133u, 134u, 135u, 136u, 137u, 138u, 139u, 140u, 141u, 142u, 143u,
+    144u, 145u, 146u, 147u, 148u, 149u, 150u, 151u, 152u, 153u, 154u, 155u, 156u, 157u, 158u, 159u,
+    160u, 161u, 162u, 163u, 164u, 165u, 166u, 167u, 168u, 169u, 170u, 171u, 172u, 173u, 174u, 175u,
+    176u, 177u, 178u, 179u, 180u, 181u, 182u, 183u, 184u, 185u, 186u, 187u, 188u, 189u, 190u, 191u,
+    192u, 193u, 194u, 195u, 196u, 197u, 198u, 199u, 200u, 201u, 202u, 203u, 204u, 205u, 206u, 207u,
+    208u, 209u, 210u, 211u, 212u, 213u, 214u, 215u, 216u, 217u, 218u, 219u, 220u, 221u, 222u, 223u,
+    224u, 225u, 226u, 227u, 228u, 229u, 230u, 231u, 232u, 233u, 234u, 235u, 236u, 237u, 238u, 239u,
+    240u, 241u, 242u, 243u, 244u, 245u, 246u, 247u, 248u, 249u, 250u, 251u, 252u, 253u, 254u, 255u
+};
+
+
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,44 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoWavetable.h
+ *      \brief      Wavetables of the TimerTwo waveform generators
+ *
+ *      \details    One period of 256 unsigned 8 bit samples in program memory, indexed by the upper 8 bits of a phase
+ *                  accumulator. Used by TimerTwoDds and TimerTwoTone, own tables have the same format.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOWAVETABLE_H_
+#define _TIMERTWOWAVETABLE_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoHal.h"
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+#define TIMERTWO_WAVETABLE_SIZE                     256u
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL DATA
+ *****************************************************************************************************************************************************/
+extern const byte TimerTwoWavetableSine[TIMERTWO_WAVETABLE_SIZE] PROGMEM;
+extern const byte TimerTwoWavetableTriangle[TIMERTWO_WAVETABLE_SIZE] PROGMEM;
+extern const byte TimerTwoWavetableSawtooth[TIMERTWO_WAVETABLE_SIZE] PROGMEM;
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
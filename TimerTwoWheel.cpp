@@ -0,0 +1,314 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoWheel.cpp
+ *      \brief      Source file of the TimerTwo timing wheel
+ *
+ *      \details    Timers are kept in intrusive doubly linked slot lists. A timer which expires within the next 16 ticks
+ *                  is stored in level 0, timers further away in the higher levels. When the lower level wraps around the
+ *                  matching slot of the next level is cascaded down. Insert and cancel are O(1), expiry is O(1) per timer.
+ *
+ *****************************************************************************************************************************************************/
+#define _TIMERTWOWHEEL_SOURCE_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwoWheel.h"
+
+
+/******************************************************************************************************************************************************
+ * GLOBAL DATA
+ *****************************************************************************************************************************************************/
+TimerTwoWheel& Timer2Wheel = TimerTwoWheel::getInstance();    // pre-instantiate TimerTwoWheel
+
+
+/******************************************************************************************************************************************************
+ * C O N S T R U C T O R S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  CONSTRUCTOR OF TimerTwoWheel
+******************************************************************************************************************************************************/
+/*! \brief          TimerTwoWheel constructor
+ *  \details        Instantiation of the TimerTwoWheel
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+TimerTwoWheel::TimerTwoWheel()
+{
+    for(byte Level = 0u; Level < TIMERTWOWHEEL_NUMBER_OF_LEVELS; Level++) {
+        for(byte Slot = 0u; Slot < TIMERTWOWHEEL_NUMBER_OF_SLOTS; Slot++) { Slots[Level][Slot] = nullptr; }
+    }
+    NextTick = 0u;
+    resetTickCost();
+} /* TimerTwoWheel */
+
+
+/******************************************************************************************************************************************************
+  DESTRUCTOR OF TimerTwoWheel
+******************************************************************************************************************************************************/
+TimerTwoWheel::~TimerTwoWheel()
+{
+
+} /* ~TimerTwoWheel */
+
+
+/******************************************************************************************************************************************************
+  getInstance()
+******************************************************************************************************************************************************/
+TimerTwoWheel& TimerTwoWheel::getInstance()
+{
+    static TimerTwoWheel SingletonInstance;
+    return SingletonInstance;
+} /* getInstance */
+
+
+/******************************************************************************************************************************************************
+ * P U B L I C   F U N C T I O N S
+ *****************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  init()
+******************************************************************************************************************************************************/
+/*! \brief          initialization of the timing wheel
+ *  \details        this function hooks the wheel into the Timer2 overflow interrupt. The wheel ticks with the period
+ *                  set by Timer2.init() or Timer2.setPeriod().
+ *
+ *  \return         E_OK
+ *                  E_NOT_OK - Wheel could not be attached to Timer2
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoWheel::init()
+{
+    return Timer2.attachInterrupt(tickCallback);
+} /* init */
+
+
+/******************************************************************************************************************************************************
+  startTimer()
+******************************************************************************************************************************************************/
+/*! \brief          start a software timer
+ *  \details        this function (re)starts the given timer. An already running timer is restarted with the new values.
+ *                  Can be called from main context and from timer callbacks.
+ *
+ *  \param[in]      SoftTimer               statically allocated timer
+ *  \param[in]      Delay                   ticks until first expiry, has to be at least 1
+ *  \param[in]      Period                  ticks between further expiries, 0 for a one shot timer
+ *  \param[in]      Callback                function which is called in interrupt context when the timer expires
+ *  \return         E_OK
+ *                  E_NOT_OK - Delay is 0 or callback is nullptr
+ *****************************************************************************************************************************************************/
+StdReturnType TimerTwoWheel::startTimer(Timer& SoftTimer, TickType Delay, TickType Period, TimerCallbackF_void Callback)
+{
+    if((Delay != 0u) && (Callback != nullptr)) {
+        uint8_t SregSave = SREG;
+        cli();
+        if(SoftTimer.isActive()) { unlink(SoftTimer); }
+        SoftTimer.Expires = NextTick + (Delay - 1u);
+        SoftTimer.Period = Period;
+        SoftTimer.Callback = Callback;
+        enqueue(SoftTimer);
+        SREG = SregSave;
+        return E_OK;
+    }
+    return E_NOT_OK;
+} /* startTimer */
+
+
+/******************************************************************************************************************************************************
+  stopTimer()
+******************************************************************************************************************************************************/
+/*! \brief          stop a software timer
+ *  \details        this function cancels the given timer, nothing happens if it is not running
+ *
+ *  \param[in]      SoftTimer               statically allocated timer
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoWheel::stopTimer(Timer& SoftTimer)
+{
+    uint8_t SregSave = SREG;
+    cli();
+    if(SoftTimer.isActive()) { unlink(SoftTimer); }
+    SREG = SregSave;
+} /* stopTimer */
+
+
+/******************************************************************************************************************************************************
+  getTicks()
+******************************************************************************************************************************************************/
+/*! \brief          get number of processed wheel ticks
+ *  \details
+ *
+ *  \return         processed wheel ticks, wraps around after 65536 ticks
+ *****************************************************************************************************************************************************/
+TimerTwoWheel::TickType TimerTwoWheel::getTicks() const
+{
+    uint8_t SregSave = SREG;
+    cli();
+    TickType Ticks = NextTick;
+    SREG = SregSave;
+    return Ticks;
+} /* getTicks */
+
+
+/******************************************************************************************************************************************************
+  getTickCost()
+******************************************************************************************************************************************************/
+/*! \brief          get cost of the wheel ticks
+ *  \details        the cost is measured in Timer2 counts between entry and exit of tick(), so the resolution is given by
+ *                  the Timer2 prescaler. Also the number of expired timers per tick is reported.
+ *
+ *  \return         cost of the last and the most expensive tick since last reset
+ *****************************************************************************************************************************************************/
+TimerTwoWheel::TickCostType TimerTwoWheel::getTickCost() const
+{
+    uint8_t SregSave = SREG;
+    cli();
+    TickCostType Cost = TickCost;
+    SREG = SregSave;
+    return Cost;
+} /* getTickCost */
+
+
+/******************************************************************************************************************************************************
+  resetTickCost()
+******************************************************************************************************************************************************/
+void TimerTwoWheel::resetTickCost()
+{
+    uint8_t SregSave = SREG;
+    cli();
+    TickCost.Last = 0u;
+    TickCost.Max = 0u;
+    TickCost.ExpiredLast = 0u;
+    TickCost.ExpiredMax = 0u;
+    SREG = SregSave;
+} /* resetTickCost */
+
+
+/******************************************************************************************************************************************************
+  tick()
+******************************************************************************************************************************************************/
+/*! \brief          process one wheel tick
+ *  \details        this function is called by the Timer2 overflow interrupt. It cascades the higher levels if level 0
+ *                  wrapped around, calls the callbacks of all expired timers and rearms periodic timers.
+ *
+ *  \return         -
+ *****************************************************************************************************************************************************/
+void TimerTwoWheel::tick()
+{
+    byte CostStart = TCNT2;
+    byte Expired = 0u;
+    TickType Tick = NextTick;
+    byte Index = Tick & TIMERTWOWHEEL_SLOT_MASK;
+
+    /* level 0 wrapped around, move timers of the next slot of the higher levels down */
+    if(0u == Index) {
+        for(byte Level = 1u; Level < TIMERTWOWHEEL_NUMBER_OF_LEVELS; Level++) {
+            byte LevelIndex = (Tick >> (Level * TIMERTWOWHEEL_LEVEL_BITS)) & TIMERTWOWHEEL_SLOT_MASK;
+            cascade(Level, LevelIndex);
+            if(LevelIndex != 0u) { break; }
+        }
+    }
+    NextTick = Tick + 1u;
+
+    /* detach expired list, so callbacks can start and stop timers safely */
+    Timer* Expiring = Slots[0u][Index];
+    Slots[0u][Index] = nullptr;
+    if(Expiring != nullptr) { Expiring->PrevNext = &Expiring; }
+
+    while(Expiring != nullptr) {
+        Timer& SoftTimer = *Expiring;
+        unlink(SoftTimer);
+        if(SoftTimer.Period != 0u) {
+            SoftTimer.Expires += SoftTimer.Period;
+            enqueue(SoftTimer);
+        }
+        SoftTimer.Callback();
+        if(Expired < UINT8_MAX) { Expired++; }
+    }
+
+    TickCost.Last = Timer2.getCountsSince(CostStart);
+    if(TickCost.Last > TickCost.Max) { TickCost.Max = TickCost.Last; }
+    TickCost.ExpiredLast = Expired;
+    if(Expired > TickCost.ExpiredMax) { TickCost.ExpiredMax = Expired; }
+} /* tick */
+
+
+/******************************************************************************************************************************************************
+ * P R I V A T E   F U N C T I O N S
+******************************************************************************************************************************************************/
+
+/******************************************************************************************************************************************************
+  enqueue()
+******************************************************************************************************************************************************/
+/*! \brief          insert timer into the wheel
+ *  \details        the level is given by the distance to the expiry, the slot by the expiry itself.
+ *                  Interrupts have to be disabled by the caller.
+ *****************************************************************************************************************************************************/
+void TimerTwoWheel::enqueue(Timer& SoftTimer)
+{
+    TickType Delta = SoftTimer.Expires - NextTick;
+    byte Level = 0u;
+
+    while((Delta >>= TIMERTWOWHEEL_LEVEL_BITS) != 0u) { Level++; }
+
+    Timer** Head = &Slots[Level][(SoftTimer.Expires >> (Level * TIMERTWOWHEEL_LEVEL_BITS)) & TIMERTWOWHEEL_SLOT_MASK];
+    SoftTimer.Next = *Head;
+    if(SoftTimer.Next != nullptr) { SoftTimer.Next->PrevNext = &SoftTimer.Next; }
+    *Head = &SoftTimer;
+    SoftTimer.PrevNext = Head;
+} /* enqueue */
+
+
+/******************************************************************************************************************************************************
+  unlink()
+******************************************************************************************************************************************************/
+/*! \brief          remove timer from its slot list
+ *  \details        Interrupts have to be disabled by the caller.
+ *****************************************************************************************************************************************************/
+void TimerTwoWheel::unlink(Timer& SoftTimer)
+{
+    *SoftTimer.PrevNext = SoftTimer.Next;
+    if(SoftTimer.Next != nullptr) { SoftTimer.Next->PrevNext = SoftTimer.PrevNext; }
+    SoftTimer.Next = nullptr;
+    SoftTimer.PrevNext = nullptr;
+} /* unlink */
+
+
+/******************************************************************************************************************************************************
+  cascade()
+******************************************************************************************************************************************************/
+/*! \brief          move all timers of a higher level slot down to the lower levels
+ *****************************************************************************************************************************************************/
+void TimerTwoWheel::cascade(byte Level, byte Index)
+{
+    Timer* List = Slots[Level][Index];
+    Slots[Level][Index] = nullptr;
+
+    while(List != nullptr) {
+        Timer& SoftTimer = *List;
+        List = SoftTimer.Next;
+        enqueue(SoftTimer);
+    }
+} /* cascade */
+
+
+/******************************************************************************************************************************************************
+  tickCallback()
+******************************************************************************************************************************************************/
+void TimerTwoWheel::tickCallback()
+{
+    Timer2Wheel.tick();
+} /* tickCallback */
+
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,118 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwoWheel.h
+ *      \brief      Header file of the TimerTwo timing wheel
+ *
+ *      \details    Hierarchical timing wheel which multiplexes many statically allocated software timers
+ *                  on the Timer2 overflow interrupt. One wheel tick is one Timer2 period.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWOWHEEL_H_
+#define _TIMERTWOWHEEL_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include "TimerTwo.h"
+
+
+/******************************************************************************************************************************************************
+ *  LOCAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* each level of the wheel has 2^LEVEL_BITS slots, all levels together cover the whole 16 bit tick range */
+#define TIMERTWOWHEEL_LEVEL_BITS                    4u
+#define TIMERTWOWHEEL_NUMBER_OF_SLOTS               (1u << TIMERTWOWHEEL_LEVEL_BITS)
+#define TIMERTWOWHEEL_SLOT_MASK                     (TIMERTWOWHEEL_NUMBER_OF_SLOTS - 1u)
+#define TIMERTWOWHEEL_NUMBER_OF_LEVELS              (16u / TIMERTWOWHEEL_LEVEL_BITS)
+
+
+/******************************************************************************************************************************************************
+ *  CLASS  TimerTwoWheel
+ *****************************************************************************************************************************************************/
+class TimerTwoWheel
+{
+/******************************************************************************************************************************************************
+ *  P U B L I C   D A T A   T Y P E S   A N D   S T R U C T U R E S
+******************************************************************************************************************************************************/
+  public:
+    /* Software timer callback function, called in interrupt context */
+    typedef void (*TimerCallbackF_void)(void);
+
+    /* Wheel ticks, one tick is one Timer2 period */
+    using TickType = uint16_t;
+
+    /* Software timer, has to be statically allocated by the user. The wheel links it intrusively, so no heap is needed */
+    class Timer
+    {
+        friend class TimerTwoWheel;
+        Timer* Next;
+        Timer** PrevNext;
+        TickType Expires;
+        TickType Period;
+        TimerCallbackF_void Callback;
+
+      public:
+        Timer() : Next(nullptr), PrevNext(nullptr), Expires(0u), Period(0u), Callback(nullptr) { }
+        bool isActive() const { return PrevNext != nullptr; }
+    };
+
+    /* Cost of the last and of the most expensive wheel tick in Timer2 counts */
+    struct TickCostType {
+        uint16_t Last;
+        uint16_t Max;
+        byte ExpiredLast;
+        byte ExpiredMax;
+    };
+
+/******************************************************************************************************************************************************
+ *  P R I V A T E   D A T A   A N D   F U N C T I N O N S
+******************************************************************************************************************************************************/
+  private:
+    TimerTwoWheel();
+    ~TimerTwoWheel();
+    TimerTwoWheel(const TimerTwoWheel&);
+
+    Timer* Slots[TIMERTWOWHEEL_NUMBER_OF_LEVELS][TIMERTWOWHEEL_NUMBER_OF_SLOTS];
+    volatile TickType NextTick;
+    TickCostType TickCost;
+
+    // methods
+    void enqueue(Timer&);
+    void unlink(Timer&);
+    void cascade(byte, byte);
+    static void tickCallback();
+
+/******************************************************************************************************************************************************
+ *  P U B L I C   F U N C T I O N S
+******************************************************************************************************************************************************/
+  public:
+    static TimerTwoWheel& getInstance();
+
+    // get methods
+    TickType getTicks() const;
+    TickCostType getTickCost() const;
+
+    // methods
+    StdReturnType init();
+    StdReturnType startTimer(Timer&, TickType, TickType, TimerCallbackF_void);
+    void stopTimer(Timer&);
+    void resetTickCost();
+    void tick();
+};
+
+/* TimerTwoWheel will be pre-instantiated in TimerTwoWheel source file */
+extern TimerTwoWheel& Timer2Wheel;
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/
@@ -0,0 +1,123 @@
+/******************************************************************************************************************************************************
+ *  COPYRIGHT
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  \verbatim
+ *  Copyright (c) Andreas Burnickl                                                                                                 All rights reserved.
+ *
+ *  \endverbatim
+ *  ---------------------------------------------------------------------------------------------------------------------------------------------------
+ *  FILE DESCRIPTION
+ *  -------------------------------------------------------------------------------------------------------------------------------------------------*/
+/**     \file       TimerTwo_Cfg.h
+ *      \brief      Configuration file of TimerTwo library
+ *
+ *      \details    Compile time configuration of the TimerTwo library. All switches can also be given as compiler define.
+ *
+ *****************************************************************************************************************************************************/
+#ifndef _TIMERTWO_CFG_H_
+#define _TIMERTWO_CFG_H_
+
+/******************************************************************************************************************************************************
+ * INCLUDES
+ *****************************************************************************************************************************************************/
+#include <StandardTypes.h>
+
+
+/******************************************************************************************************************************************************
+ *  GLOBAL CONSTANT MACROS
+ *****************************************************************************************************************************************************/
+/* waveform generation modes, the value is the WGM2[2:0] bit group of the mode */
+#define TIMERTWO_MODE_NORMAL                        0u      /* normal, TOP = 0xFF, no PWM, counts up only */
+#define TIMERTWO_MODE_PHASE_CORRECT_8BIT            1u      /* PWM phase correct, TOP = 0xFF, PWM on pin 11 and pin 3 */
+#define TIMERTWO_MODE_CTC                           2u      /* CTC, TOP = OCR2A, no PWM, tick at compare match A */
+#define TIMERTWO_MODE_FAST_PWM_8BIT                 3u      /* fast PWM, TOP = 0xFF, PWM on pin 11 and pin 3 */
+#define TIMERTWO_MODE_PHASE_CORRECT                 5u      /* PWM phase correct, TOP = OCR2A, period 2 * TOP counts */
+#define TIMERTWO_MODE_FAST_PWM                      7u      /* fast PWM, TOP = OCR2A, period TOP + 1 counts */
+
+/* waveform generation mode of Timer2 */
+#ifndef TIMERTWO_WAVEFORM_MODE
+# define TIMERTWO_WAVEFORM_MODE                     TIMERTWO_MODE_PHASE_CORRECT
+#endif
+
+/* latency and callback duration statistics of the timer tick (getStats()), 0 removes all instrumentation */
+#ifndef TIMERTWO_STATISTICS
+# define TIMERTWO_STATISTICS                        0
+#endif
+/* number of histogram bins and width of one bin as power of two timer counts, the last bin takes all greater values */
+#ifndef TIMERTWO_STATISTICS_BINS
+# define TIMERTWO_STATISTICS_BINS                   8u
+#endif
+#ifndef TIMERTWO_STATISTICS_BIN_SHIFT
+# define TIMERTWO_STATISTICS_BIN_SHIFT              2u
+#endif
+
+/* sampling profiler in the timer tick (TimerTwoProfiler.h), AVR only, 0 removes it */
+#ifndef TIMERTWO_PROFILER
+# define TIMERTWO_PROFILER                          0
+#endif
+/* PC histogram: number of bins (2 bytes RAM each), program words per bin as power of two and first program word */
+#ifndef TIMERTWO_PROFILER_BINS
+# define TIMERTWO_PROFILER_BINS                     256u
+#endif
+#ifndef TIMERTWO_PROFILER_BIN_SHIFT
+# define TIMERTWO_PROFILER_BIN_SHIFT                6u
+#endif
+#ifndef TIMERTWO_PROFILER_PC_START
+# define TIMERTWO_PROFILER_PC_START                 0u
+#endif
+
+/* software PWM on pins of PORTB, PORTC and PORTD (TimerTwoSoftPwm.h), number of channels, 0 removes it */
+#ifndef TIMERTWO_SOFTPWM_CHANNELS
+# define TIMERTWO_SOFTPWM_CHANNELS                  0u
+#endif
+
+/* bit angle modulation LED matrix driver (TimerTwoBam.h), needs TIMERTWO_MODE_CTC, number of rows and columns, 0 rows removes it */
+#ifndef TIMERTWO_BAM_ROWS
+# define TIMERTWO_BAM_ROWS                          0u
+#endif
+#ifndef TIMERTWO_BAM_COLUMNS
+# define TIMERTWO_BAM_COLUMNS                       8u
+#endif
+
+/* direct digital synthesis on pin 3 (TimerTwoDds.h), needs TIMERTWO_MODE_FAST_PWM_8BIT or TIMERTWO_MODE_PHASE_CORRECT_8BIT, 0 removes it */
+#ifndef TIMERTWO_DDS
+# define TIMERTWO_DDS                               0
+#endif
+/* clock select bit group of the DDS sample rate (1: no prescaler, 2: 8, 3: 32, 4: 64, 5: 128, 6: 256, 7: 1024) */
+#ifndef TIMERTWO_DDS_CLOCK_SELECT
+# define TIMERTWO_DDS_CLOCK_SELECT                  1u
+#endif
+
+/* polyphonic tone generator on pin 3 (TimerTwoTone.h), number of voices (1, 2, 4 or 8), 0 removes it. Needs
+ * TIMERTWO_MODE_FAST_PWM_8BIT or TIMERTWO_MODE_PHASE_CORRECT_8BIT, the callback period is made by the postscaler */
+#ifndef TIMERTWO_TONE_VOICES
+# define TIMERTWO_TONE_VOICES                       0u
+#endif
+/* clock select bit group of the tone sample rate (1: no prescaler, 2: 8) */
+#ifndef TIMERTWO_TONE_CLOCK_SELECT
+# define TIMERTWO_TONE_CLOCK_SELECT                 1u
+#endif
+
+/* PCM sample player on pin 3 (TimerTwoPcm.h), needs TIMERTWO_MODE_FAST_PWM, 0 removes it */
+#ifndef TIMERTWO_PCM
+# define TIMERTWO_PCM                               0
+#endif
+/* samples per prefetched block, 2 to 64. The prefetch takes about 14 cycles per sample and has to end within two sample periods */
+#ifndef TIMERTWO_PCM_BLOCK_SIZE
+# define TIMERTWO_PCM_BLOCK_SIZE                    32u
+#endif
+/* capacity of the ring buffer of the stream (write()), power of two, at most 128 */
+#ifndef TIMERTWO_PCM_RING_SIZE
+# define TIMERTWO_PCM_RING_SIZE                     128u
+#endif
+
+/* capacity of the deferred work queue (defer() / dispatch()), power of two, at most 128 */
+#ifndef TIMERTWO_DEFERRED_QUEUE_SIZE
+# define TIMERTWO_DEFERRED_QUEUE_SIZE               8u
+#endif
+
+#endif
+
+/******************************************************************************************************************************************************
+ *  E N D   O F   F I L E
+ *****************************************************************************************************************************************************/